@@ -1,13 +1,249 @@
 #include <iostream>
+#include <algorithm>
 #include <stdexcept>
+#include <utility>
+#include <memory>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define DYNAMIC_ARRAY_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define DYNAMIC_ARRAY_TARGET(isa)
+#else
+#define DYNAMIC_ARRAY_TARGET(isa) __attribute__((target(isa)))
+#endif
+#endif
+
+// Поэлементные ядра сложения/вычитания с насыщением до [-100, 100].
+// Реализация выбирается один раз по возможностям процессора.
+typedef void (*SaturatingKernel)(const int* a, const int* b, int* out, size_t count);
+
+template <bool Subtract>
+void saturateScalar(const int* a, const int* b, int* out, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        int value = Subtract ? a[i] - b[i] : a[i] + b[i];
+        value = (value < -100) ? -100 : value;
+        value = (value > 100) ? 100 : value;
+        out[i] = value;
+    }
+}
+
+#ifdef DYNAMIC_ARRAY_X86
+template <bool Subtract>
+DYNAMIC_ARRAY_TARGET("sse2")
+void saturateSSE2(const int* a, const int* b, int* out, size_t count) {
+    const __m128i low = _mm_set1_epi32(-100);
+    const __m128i high = _mm_set1_epi32(100);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        __m128i value = Subtract ? _mm_sub_epi32(x, y) : _mm_add_epi32(x, y);
+        __m128i mask = _mm_cmpgt_epi32(value, high);
+        value = _mm_or_si128(_mm_and_si128(mask, high), _mm_andnot_si128(mask, value));
+        mask = _mm_cmplt_epi32(value, low);
+        value = _mm_or_si128(_mm_and_si128(mask, low), _mm_andnot_si128(mask, value));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), value);
+    }
+    saturateScalar<Subtract>(a + i, b + i, out + i, count - i);
+}
+
+template <bool Subtract>
+DYNAMIC_ARRAY_TARGET("avx2")
+void saturateAVX2(const int* a, const int* b, int* out, size_t count) {
+    const __m256i low = _mm256_set1_epi32(-100);
+    const __m256i high = _mm256_set1_epi32(100);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        __m256i value = Subtract ? _mm256_sub_epi32(x, y) : _mm256_add_epi32(x, y);
+        value = _mm256_min_epi32(_mm256_max_epi32(value, low), high);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), value);
+    }
+    saturateScalar<Subtract>(a + i, b + i, out + i, count - i);
+}
+
+template <bool Subtract>
+DYNAMIC_ARRAY_TARGET("avx512f")
+void saturateAVX512(const int* a, const int* b, int* out, size_t count) {
+    const __m512i low = _mm512_set1_epi32(-100);
+    const __m512i high = _mm512_set1_epi32(100);
+    const __mmask16 allLanes = 0xFFFF;
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m512i x = _mm512_loadu_si512(a + i);
+        __m512i y = _mm512_loadu_si512(b + i);
+        __m512i value = Subtract ? _mm512_sub_epi32(x, y) : _mm512_add_epi32(x, y);
+        // maskz-варианты с полной маской дают те же vpmaxsd/vpminsd, но без
+        // ложного -Wmaybe-uninitialized из _mm512_undefined_epi32 в GCC
+        value = _mm512_maskz_min_epi32(allLanes, _mm512_maskz_max_epi32(allLanes, value, low), high);
+        _mm512_storeu_si512(out + i, value);
+    }
+    saturateScalar<Subtract>(a + i, b + i, out + i, count - i);
+}
+#endif
+
+enum class SimdLevel { Scalar, SSE2, AVX2, AVX512 };
+
+inline SimdLevel detectSimdLevel() {
+#if !defined(DYNAMIC_ARRAY_X86)
+    return SimdLevel::Scalar;
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    int maxLeaf = info[0];
+    __cpuid(info, 1);
+    bool sse2 = (info[3] & (1 << 26)) != 0;
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    if (osxsave && avx && maxLeaf >= 7) {
+        unsigned long long xcr0 = _xgetbv(0);
+        __cpuidex(info, 7, 0);
+        if ((xcr0 & 0xE6) == 0xE6 && (info[1] & (1 << 16)) != 0) {
+            return SimdLevel::AVX512;
+        }
+        if ((xcr0 & 0x6) == 0x6 && (info[1] & (1 << 5)) != 0) {
+            return SimdLevel::AVX2;
+        }
+    }
+    return sse2 ? SimdLevel::SSE2 : SimdLevel::Scalar;
+#else
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return SimdLevel::AVX512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return SimdLevel::AVX2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return SimdLevel::SSE2;
+    }
+    return SimdLevel::Scalar;
+#endif
+}
+
+template <bool Subtract>
+SaturatingKernel selectSaturatingKernel() {
+    static const SimdLevel level = detectSimdLevel();
+    switch (level) {
+#ifdef DYNAMIC_ARRAY_X86
+        case SimdLevel::AVX512:
+            return saturateAVX512<Subtract>;
+        case SimdLevel::AVX2:
+            return saturateAVX2<Subtract>;
+        case SimdLevel::SSE2:
+            return saturateSSE2<Subtract>;
+#endif
+        default:
+            return saturateScalar<Subtract>;
+    }
+}
+
+// Индекс первого значения вне [-100, 100] или count, если все в диапазоне.
+// Векторные версии считают минимум и максимум блока и ищут нарушителя
+// поэлементно только в том блоке, где он есть.
+typedef size_t (*RangeCheckKernel)(const int* values, size_t count);
+
+static const size_t rangeCheckBlock = 1024;
+
+size_t findOutOfRangeScalar(const int* values, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        if (values[i] < -100 || values[i] > 100) {
+            return i;
+        }
+    }
+    return count;
+}
+
+#ifdef DYNAMIC_ARRAY_X86
+DYNAMIC_ARRAY_TARGET("sse2")
+size_t findOutOfRangeSSE2(const int* values, size_t count) {
+    const __m128i low = _mm_set1_epi32(-100);
+    const __m128i high = _mm_set1_epi32(100);
+    size_t begin = 0;
+    for (; begin + rangeCheckBlock <= count; begin += rangeCheckBlock) {
+        __m128i bad = _mm_setzero_si128();
+        for (size_t i = begin; i < begin + rangeCheckBlock; i += 4) {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+            bad = _mm_or_si128(bad, _mm_or_si128(_mm_cmplt_epi32(x, low), _mm_cmpgt_epi32(x, high)));
+        }
+        if (_mm_movemask_epi8(bad) != 0) {
+            return begin + findOutOfRangeScalar(values + begin, rangeCheckBlock);
+        }
+    }
+    return begin + findOutOfRangeScalar(values + begin, count - begin);
+}
+
+DYNAMIC_ARRAY_TARGET("avx2")
+size_t findOutOfRangeAVX2(const int* values, size_t count) {
+    const __m256i low = _mm256_set1_epi32(-100);
+    const __m256i high = _mm256_set1_epi32(100);
+    size_t begin = 0;
+    for (; begin + rangeCheckBlock <= count; begin += rangeCheckBlock) {
+        __m256i minimum = _mm256_setzero_si256();
+        __m256i maximum = _mm256_setzero_si256();
+        for (size_t i = begin; i < begin + rangeCheckBlock; i += 8) {
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+            minimum = _mm256_min_epi32(minimum, x);
+            maximum = _mm256_max_epi32(maximum, x);
+        }
+        __m256i bad = _mm256_or_si256(_mm256_cmpgt_epi32(low, minimum), _mm256_cmpgt_epi32(maximum, high));
+        if (!_mm256_testz_si256(bad, bad)) {
+            return begin + findOutOfRangeScalar(values + begin, rangeCheckBlock);
+        }
+    }
+    return begin + findOutOfRangeScalar(values + begin, count - begin);
+}
+
+DYNAMIC_ARRAY_TARGET("avx512f")
+size_t findOutOfRangeAVX512(const int* values, size_t count) {
+    const __m512i low = _mm512_set1_epi32(-100);
+    const __m512i high = _mm512_set1_epi32(100);
+    size_t begin = 0;
+    for (; begin + rangeCheckBlock <= count; begin += rangeCheckBlock) {
+        // Маски сравнений копятся напрямую: min/max-редукция через
+        // _mm512_min_epi32 дает в GCC ложное -Wmaybe-uninitialized
+        __mmask16 outside = 0;
+        for (size_t i = begin; i < begin + rangeCheckBlock; i += 16) {
+            __m512i x = _mm512_loadu_si512(values + i);
+            outside |= _mm512_cmplt_epi32_mask(x, low) | _mm512_cmpgt_epi32_mask(x, high);
+        }
+        if (outside != 0) {
+            return begin + findOutOfRangeScalar(values + begin, rangeCheckBlock);
+        }
+    }
+    return begin + findOutOfRangeScalar(values + begin, count - begin);
+}
+#endif
+
+inline RangeCheckKernel selectRangeCheckKernel() {
+    static const SimdLevel level = detectSimdLevel();
+    switch (level) {
+#ifdef DYNAMIC_ARRAY_X86
+        case SimdLevel::AVX512:
+            return findOutOfRangeAVX512;
+        case SimdLevel::AVX2:
+            return findOutOfRangeAVX2;
+        case SimdLevel::SSE2:
+            return findOutOfRangeSSE2;
+#endif
+        default:
+            return findOutOfRangeScalar;
+    }
+}
 
 class DynamicArray {
 private:
     int* data;
     size_t size;
+    size_t allocated;
 
 public:
-    DynamicArray(size_t arraySize) : size(arraySize) {
+    DynamicArray(size_t arraySize) : size(arraySize), allocated(arraySize) {
         if (size > 0) {
             data = new int[size];
             for (size_t i = 0; i < size; ++i) {
@@ -18,7 +254,7 @@ public:
         }
     }
 
-    DynamicArray(const DynamicArray& other) : size(other.size) {
+    DynamicArray(const DynamicArray& other) : size(other.size), allocated(other.size) {
         if (size > 0) {
             data = new int[size];
             for (size_t i = 0; i < size; ++i) {
@@ -29,6 +265,13 @@ public:
         }
     }
 
+    DynamicArray(DynamicArray&& other) noexcept
+        : data(other.data), size(other.size), allocated(other.allocated) {
+        other.data = nullptr;
+        other.size = 0;
+        other.allocated = 0;
+    }
+
     ~DynamicArray() {
         delete[] data;
     }
@@ -65,33 +308,91 @@ public:
             throw std::invalid_argument("Значение должно быть в диапазоне от -100 до 100");
         }
 
-        size_t newSize = size + 1;
-        int* newData = new int[newSize];
+        if (size == allocated) {
+            reserve(allocated > 0 ? allocated * 2 : 1);
+        }
+        data[size++] = value;
+    }
 
+    void reserve(size_t newCapacity) {
+        if (newCapacity <= allocated) {
+            return;
+        }
+
+        int* newData = new int[newCapacity];
         for (size_t i = 0; i < size; ++i) {
             newData[i] = data[i];
         }
 
-        newData[size] = value;
         delete[] data;
         data = newData;
-        size = newSize;
+        allocated = newCapacity;
+    }
+
+    void shrinkToFit() {
+        if (allocated == size) {
+            return;
+        }
+
+        int* newData = nullptr;
+        if (size > 0) {
+            newData = new int[size];
+            for (size_t i = 0; i < size; ++i) {
+                newData[i] = data[i];
+            }
+        }
+
+        delete[] data;
+        data = newData;
+        allocated = size;
+    }
+
+    // Пакетное заполнение: весь буфер проверяется одним векторным проходом
+    // до изменения массива, при ошибке массив остается прежним. Память
+    // перераспределяется не больше одного раза. Буфер не должен указывать
+    // внутрь самого массива.
+    void appendRange(const int* values, size_t count) {
+        checkRange(values, count);
+        if (size + count > allocated) {
+            size_t grown = allocated * 2;
+            reserve((grown > size + count) ? grown : size + count);
+        }
+        for (size_t i = 0; i < count; ++i) {
+            data[size + i] = values[i];
+        }
+        size += count;
+    }
+
+    // Заменяет содержимое значениями из [first, last)
+    void assign(const int* first, const int* last) {
+        size_t count = static_cast<size_t>(last - first);
+        checkRange(first, count);
+        if (count > allocated) {
+            int* newData = new int[count];
+            delete[] data;
+            data = newData;
+            allocated = count;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            data[i] = first[i];
+        }
+        size = count;
+    }
+
+    // Присваивает value всем элементам
+    void fill(int value) {
+        if (value < -100 || value > 100) {
+            throw std::invalid_argument("Значение должно быть в диапазоне от -100 до 100");
+        }
+        for (size_t i = 0; i < size; ++i) {
+            data[i] = value;
+        }
     }
 
     DynamicArray add(const DynamicArray& other) const {
         size_t maxSize = (size > other.size) ? size : other.size;
         DynamicArray result(maxSize);
-
-        for (size_t i = 0; i < maxSize; ++i) {
-            int value1 = (i < size) ? data[i] : 0;
-            int value2 = (i < other.size) ? other.data[i] : 0;
-            int sum = value1 + value2;
-            
-            if (sum < -100) sum = -100;
-            if (sum > 100) sum = 100;
-            
-            result.data[i] = sum;
-        }
+        combineInto<false>(other, result);
 
         return result;
     }
@@ -99,17 +400,7 @@ public:
     DynamicArray subtract(const DynamicArray& other) const {
         size_t maxSize = (size > other.size) ? size : other.size;
         DynamicArray result(maxSize);
-
-        for (size_t i = 0; i < maxSize; ++i) {
-            int value1 = (i < size) ? data[i] : 0;
-            int value2 = (i < other.size) ? other.data[i] : 0;
-            int diff = value1 - value2;
-            
-            if (diff < -100) diff = -100;
-            if (diff > 100) diff = 100;
-            
-            result.data[i] = diff;
-        }
+        combineInto<true>(other, result);
 
         return result;
     }
@@ -119,20 +410,247 @@ public:
         return size;
     }
 
+    size_t capacity() const {
+        return allocated;
+    }
+
     DynamicArray& operator=(const DynamicArray& other) {
         if (this != &other) {
-            delete[] data;
-            size = other.size;
-            if (size > 0) {
-                data = new int[size];
-                for (size_t i = 0; i < size; ++i) {
-                    data[i] = other.data[i];
+            DynamicArray copy(other);
+            swap(copy);
+        }
+        return *this;
+    }
+
+    DynamicArray& operator=(DynamicArray&& other) noexcept {
+        if (this != &other) {
+            DynamicArray moved(std::move(other));
+            swap(moved);
+        }
+        return *this;
+    }
+
+    void swap(DynamicArray& other) noexcept {
+        std::swap(data, other.data);
+        std::swap(size, other.size);
+        std::swap(allocated, other.allocated);
+    }
+
+    friend void swap(DynamicArray& a, DynamicArray& b) noexcept {
+        a.swap(b);
+    }
+
+private:
+    static void checkRange(const int* values, size_t count) {
+        size_t bad = selectRangeCheckKernel()(values, count);
+        if (bad < count) {
+            throw std::invalid_argument("Значение с индексом " + std::to_string(bad) + " должно быть в диапазоне от -100 до 100");
+        }
+    }
+
+    // Общая часть массивов считается векторным ядром, хвост более длинного
+    // операнда уже лежит в диапазоне и копируется без насыщения
+    template <bool Subtract>
+    void combineInto(const DynamicArray& other, DynamicArray& result) const {
+        size_t overlap = (size < other.size) ? size : other.size;
+        if (overlap > 0) {
+            selectSaturatingKernel<Subtract>()(data, other.data, result.data, overlap);
+        }
+        for (size_t i = overlap; i < size; ++i) {
+            result.data[i] = data[i];
+        }
+        for (size_t i = overlap; i < other.size; ++i) {
+            result.data[i] = Subtract ? -other.data[i] : other.data[i];
+        }
+    }
+};
+
+// Массив из блоков по chunkSize элементов. pushBack никогда не переносит
+// элементы полных блоков: при заполнении последнего блока добавляется
+// новый, а таблица блоков хранит только указатели. Последний блок занимает
+// столько памяти, сколько ему нужно; неполный блок растет при pushBack
+// удвоением до chunkSize, поэтому переносится не больше одного блока.
+// Копия разделяет блоки с оригиналом (копируются указатели), а блок
+// копируется при первой записи в него, пока им владеет больше одного
+// массива. Сложение и вычитание идут по блокам векторным ядром.
+class SegmentedDynamicArray {
+public:
+    static const size_t chunkSize = 1 << 16;
+
+    SegmentedDynamicArray(size_t arraySize) : size(arraySize), lastCapacity(0) {
+        size_t count = (size + chunkSize - 1) / chunkSize;
+        chunks.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            lastCapacity = (size - i * chunkSize < chunkSize) ? size - i * chunkSize : chunkSize;
+            Chunk chunk = makeChunk(lastCapacity);
+            std::fill(chunk.get(), chunk.get() + lastCapacity, 0);
+            chunks.push_back(chunk);
+        }
+    }
+
+    SegmentedDynamicArray(const SegmentedDynamicArray& other) = default;
+
+    SegmentedDynamicArray(SegmentedDynamicArray&& other) noexcept
+        : chunks(std::move(other.chunks)), size(other.size), lastCapacity(other.lastCapacity) {
+        other.chunks.clear();
+        other.size = 0;
+        other.lastCapacity = 0;
+    }
+
+    SegmentedDynamicArray& operator=(const SegmentedDynamicArray& other) {
+        if (this != &other) {
+            SegmentedDynamicArray copy(other);
+            swap(copy);
+        }
+        return *this;
+    }
+
+    SegmentedDynamicArray& operator=(SegmentedDynamicArray&& other) noexcept {
+        if (this != &other) {
+            SegmentedDynamicArray moved(std::move(other));
+            swap(moved);
+        }
+        return *this;
+    }
+
+    void swap(SegmentedDynamicArray& other) noexcept {
+        chunks.swap(other.chunks);
+        std::swap(size, other.size);
+        std::swap(lastCapacity, other.lastCapacity);
+    }
+
+    friend void swap(SegmentedDynamicArray& a, SegmentedDynamicArray& b) noexcept {
+        a.swap(b);
+    }
+
+    void print() const {
+        std::cout << "Массив [размер: " << size << "]: ";
+        for (size_t i = 0; i < size; ++i) {
+            std::cout << chunks[i / chunkSize][i % chunkSize];
+            if (i < size - 1) {
+                std::cout << ", ";
+            }
+        }
+        std::cout << std::endl;
+    }
+
+    void setValue(size_t index, int value) {
+        if (index >= size) {
+            throw std::out_of_range("Индекс выходит за границы массива");
+        }
+        if (value < -100 || value > 100) {
+            throw std::invalid_argument("Значение должно быть в диапазоне от -100 до 100");
+        }
+        writableChunk(index / chunkSize, index % chunkSize + 1)[index % chunkSize] = value;
+    }
+
+    int getValue(size_t index) const {
+        if (index >= size) {
+            throw std::out_of_range("Индекс выходит за границы массива");
+        }
+        return chunks[index / chunkSize][index % chunkSize];
+    }
+
+    void pushBack(int value) {
+        if (value < -100 || value > 100) {
+            throw std::invalid_argument("Значение должно быть в диапазоне от -100 до 100");
+        }
+
+        // Массив, переросший один блок, дальше растет сразу полными блоками
+        if (size == chunks.size() * chunkSize) {
+            lastCapacity = chunks.empty() ? 1 : chunkSize;
+            chunks.push_back(makeChunk(lastCapacity));
+        }
+        writableChunk(size / chunkSize, size % chunkSize + 1)[size % chunkSize] = value;
+        ++size;
+    }
+
+    SegmentedDynamicArray add(const SegmentedDynamicArray& other) const {
+        return combine<false>(other);
+    }
+
+    SegmentedDynamicArray subtract(const SegmentedDynamicArray& other) const {
+        return combine<true>(other);
+    }
+
+    size_t getSize() const {
+        return size;
+    }
+
+    size_t getChunkCount() const {
+        return chunks.size();
+    }
+
+private:
+    typedef std::shared_ptr<int[]> Chunk;
+
+    // Все блоки, кроме последнего, вмещают chunkSize элементов;
+    // емкость последнего хранится в lastCapacity
+    std::vector<Chunk> chunks;
+    size_t size;
+    size_t lastCapacity;
+
+    // Память блока не заполняется: вызывающий код сам записывает элементы
+    static Chunk makeChunk(size_t capacity) {
+        return Chunk(new int[capacity]);
+    }
+
+    // Блок, которым владеет только этот массив и в котором есть место
+    // под needed элементов. Общий блок сначала копируется, короткий
+    // последний блок растет удвоением до chunkSize.
+    int* writableChunk(size_t index, size_t needed) {
+        bool last = index + 1 == chunks.size();
+        size_t capacity = last ? lastCapacity : chunkSize;
+        if (chunks[index].use_count() == 1 && capacity >= needed) {
+            return chunks[index].get();
+        }
+        if (capacity < needed) {
+            capacity = (capacity * 2 > needed) ? capacity * 2 : needed;
+            capacity = (capacity < chunkSize) ? capacity : chunkSize;
+        }
+        size_t begin = index * chunkSize;
+        size_t length = (size - begin < chunkSize) ? size - begin : chunkSize;
+        Chunk copy = makeChunk(capacity);
+        std::copy(chunks[index].get(), chunks[index].get() + length, copy.get());
+        chunks[index] = copy;
+        if (last) {
+            lastCapacity = capacity;
+        }
+        return copy.get();
+    }
+
+    // Элементы за концом более короткого массива считаются нулями
+    template <bool Subtract>
+    SegmentedDynamicArray combine(const SegmentedDynamicArray& other) const {
+        size_t maxSize = (size > other.size) ? size : other.size;
+        size_t overlap = (size < other.size) ? size : other.size;
+        // Хвост за концом более короткого массива берется из более длинного
+        const SegmentedDynamicArray& longer = (size >= other.size) ? *this : other;
+        bool negateTail = Subtract && &longer == &other;
+        SegmentedDynamicArray result(0);
+        result.lastCapacity = (maxSize % chunkSize != 0) ? maxSize % chunkSize : chunkSize;
+        result.chunks.reserve((maxSize + chunkSize - 1) / chunkSize);
+        for (size_t begin = 0; begin < maxSize; begin += chunkSize) {
+            size_t end = (begin + chunkSize < maxSize) ? begin + chunkSize : maxSize;
+            size_t chunk = begin / chunkSize;
+            size_t overlapEnd = (overlap > begin) ? ((overlap < end) ? overlap : end) : begin;
+            Chunk out = makeChunk(end - begin);
+            if (overlapEnd > begin) {
+                selectSaturatingKernel<Subtract>()(chunks[chunk].get(), other.chunks[chunk].get(),
+                                                   out.get(), overlapEnd - begin);
+            }
+            const int* tail = longer.chunks[chunk].get();
+            if (negateTail) {
+                for (size_t i = overlapEnd - begin; i < end - begin; ++i) {
+                    out[i] = -tail[i];
                 }
             } else {
-                data = nullptr;
+                std::copy(tail + (overlapEnd - begin), tail + (end - begin), out.get() + (overlapEnd - begin));
             }
+            result.chunks.push_back(out);
         }
-        return *this;
+        result.size = maxSize;
+        return result;
     }
 };
 
@@ -142,25 +660,39 @@ int main() {
         
         std::cout << "Введите размер первого массива: ";
         std::cin >> size1;
-        DynamicArray arr1(size1);
+        DynamicArray arr1(0);
         
         std::cout << "Введите " << size1 << " элементов первого массива (от -100 до 100):" << std::endl;
+        // Значение проверяется сразу после ввода, весь ввод копируется в массив
+        // одним assign, без предварительного заполнения нулями
+        std::vector<int> values1;
+        values1.reserve(size1);
         for (int i = 0; i < size1; ++i) {
             int value;
             std::cin >> value;
-            arr1.setValue(i, value);
+            if (value < -100 || value > 100) {
+                throw std::invalid_argument("Значение должно быть в диапазоне от -100 до 100");
+            }
+            values1.push_back(value);
         }
+        arr1.assign(values1.data(), values1.data() + values1.size());
         
         std::cout << "Введите размер второго массива: ";
         std::cin >> size2;
-        DynamicArray arr2(size2);
+        DynamicArray arr2(0);
         
         std::cout << "Введите " << size2 << " элементов второго массива (от -100 до 100):" << std::endl;
+        std::vector<int> values2;
+        values2.reserve(size2);
         for (int i = 0; i < size2; ++i) {
             int value;
             std::cin >> value;
-            arr2.setValue(i, value);
+            if (value < -100 || value > 100) {
+                throw std::invalid_argument("Значение должно быть в диапазоне от -100 до 100");
+            }
+            values2.push_back(value);
         }
+        arr2.assign(values2.data(), values2.data() + values2.size());
         
         std::cout << "\nПервый массив: ";
         arr1.print();
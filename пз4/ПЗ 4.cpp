@@ -1,43 +1,1455 @@
 #include <iostream>
 #include <stdexcept>
+#include <utility>
 #include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <new>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
 
-class DynamicArray {
-private:
-    int* data;
-    size_t size;
+#if defined(__has_include)
+#if __has_include(<span>)
+#include <span>
+#endif
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#define DYNAMIC_ARRAY_MMAP 1
+#include <sys/mman.h>
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define DYNAMIC_ARRAY_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define DYNAMIC_ARRAY_TARGET(isa)
+#else
+#define DYNAMIC_ARRAY_TARGET(isa) __attribute__((target(isa)))
+#endif
+#endif
+
+// What add/subtract do when a result leaves the value domain
+enum class OverflowPolicy { Saturate, Wrap, Throw };
+
+// Narrowest of int8_t, uint8_t, int16_t, uint16_t and int that holds [Min, Max]
+template <int Min, int Max>
+struct NarrowestStorage {
+    typedef typename std::conditional<(Min >= -128 && Max <= 127), int8_t,
+            typename std::conditional<(Min >= 0 && Max <= 255), uint8_t,
+            typename std::conditional<(Min >= -32768 && Max <= 32767), int16_t,
+            typename std::conditional<(Min >= 0 && Max <= 65535), uint16_t,
+                                      int>::type>::type>::type>::type type;
+};
+
+// Compile-time description of the values an array may hold: the bounds,
+// the overflow policy and the storage type (the narrowest one by default).
+template <int Min, int Max, OverflowPolicy Policy = OverflowPolicy::Saturate,
+          typename Storage = typename NarrowestStorage<Min, Max>::type>
+struct ValueDomain {
+    typedef Storage StorageType;
+
+    static const int minValue = Min;
+    static const int maxValue = Max;
+    static const OverflowPolicy policy = Policy;
+    // Every value of the storage type is in the domain, so the saturating
+    // and wrapping instructions of the storage type need no extra clamping
+    static const bool fullRange = Min == std::numeric_limits<Storage>::min() &&
+                                  Max == std::numeric_limits<Storage>::max();
+
+    static_assert(Min <= 0 && Max >= 0, "The domain must contain zero: new elements start at zero");
+    static_assert(Min >= std::numeric_limits<Storage>::min() && Max <= std::numeric_limits<Storage>::max(),
+                  "The storage type cannot hold the domain");
+    static_assert(sizeof(Storage) < sizeof(int) ||
+                  (Min >= std::numeric_limits<int>::min() / 2 && Max <= std::numeric_limits<int>::max() / 2),
+                  "Sums and differences of two values must fit in int");
+
+    static bool contains(int value) {
+        return value >= Min && value <= Max;
+    }
+
+    static std::string rangeText() {
+        return "from " + std::to_string(Min) + " to " + std::to_string(Max);
+    }
+
+    // Scalar reference for one element; the vector kernels must match it
+    template <bool Subtract>
+    static Storage combine(int a, int b);
+};
+
+template <typename Domain>
+[[noreturn]] void throwOverflow() {
+    throw std::overflow_error("Result is out of range " + Domain::rangeText());
+}
+
+template <int Min, int Max, OverflowPolicy Policy, typename Storage>
+template <bool Subtract>
+Storage ValueDomain<Min, Max, Policy, Storage>::combine(int a, int b) {
+    int value = Subtract ? a - b : a + b;
+    if (value < Min || value > Max) {
+        if (Policy == OverflowPolicy::Saturate) {
+            value = (value < Min) ? Min : Max;
+        } else if (Policy == OverflowPolicy::Wrap) {
+            long long range = static_cast<long long>(Max) - Min + 1;
+            long long offset = (static_cast<long long>(value) - Min) % range;
+            value = static_cast<int>(Min + ((offset < 0) ? offset + range : offset));
+        } else {
+            throwOverflow<ValueDomain>();
+        }
+    }
+    return static_cast<Storage>(value);
+}
+
+// Element-wise add/subtract kernels applying the domain's overflow policy.
+// The implementation is picked once from the CPU features.
+template <typename Domain>
+using CombineKernel = void (*)(const typename Domain::StorageType* a, const typename Domain::StorageType* b,
+                               typename Domain::StorageType* out, size_t count);
+
+template <typename Domain, bool Subtract>
+void combineScalar(const typename Domain::StorageType* a, const typename Domain::StorageType* b,
+                   typename Domain::StorageType* out, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = Domain::template combine<Subtract>(a[i], b[i]);
+    }
+}
+
+// Saturate and Throw run in vector lanes for every domain; Wrap only when
+// the domain covers its whole storage type (the native wrapping add), other
+// wrapping domains go through the scalar loop.
+#ifdef DYNAMIC_ARRAY_X86
+// Lane operations for one storage type and instruction set. addSat/subSat
+// saturate at the limits of the storage type (plain add for int, whose
+// domains are small enough not to overflow), addWrap/subWrap wrap around,
+// min/max clamp into the domain.
+struct SSE2Vector {
+    typedef __m128i Vector;
+
+    DYNAMIC_ARRAY_TARGET("sse2")
+    static __m128i load(const void* source) {
+        return _mm_loadu_si128(static_cast<const __m128i*>(source));
+    }
+
+    DYNAMIC_ARRAY_TARGET("sse2")
+    static void store(void* target, __m128i value) {
+        _mm_storeu_si128(static_cast<__m128i*>(target), value);
+    }
+
+    DYNAMIC_ARRAY_TARGET("sse2")
+    static bool differ(__m128i x, __m128i y) {
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(x, y)) != 0xFFFF;
+    }
+
+    // SSE2 has no min/max for int8, int32 and uint16; these emulate them
+    DYNAMIC_ARRAY_TARGET("sse2")
+    static __m128i select(__m128i mask, __m128i x, __m128i y) {
+        return _mm_or_si128(_mm_and_si128(mask, x), _mm_andnot_si128(mask, y));
+    }
+
+    DYNAMIC_ARRAY_TARGET("sse2")
+    static __m128i flipSign16(__m128i x) {
+        return _mm_xor_si128(x, _mm_set1_epi16(static_cast<short>(0x8000)));
+    }
+};
+
+struct AVX2Vector {
+    typedef __m256i Vector;
+
+    DYNAMIC_ARRAY_TARGET("avx2")
+    static __m256i load(const void* source) {
+        return _mm256_loadu_si256(static_cast<const __m256i*>(source));
+    }
+
+    DYNAMIC_ARRAY_TARGET("avx2")
+    static void store(void* target, __m256i value) {
+        _mm256_storeu_si256(static_cast<__m256i*>(target), value);
+    }
+
+    DYNAMIC_ARRAY_TARGET("avx2")
+    static bool differ(__m256i x, __m256i y) {
+        return _mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y)) != -1;
+    }
+};
+
+struct AVX512Vector {
+    typedef __m512i Vector;
+
+    DYNAMIC_ARRAY_TARGET("avx512f,avx512bw")
+    static __m512i load(const void* source) {
+        return _mm512_loadu_si512(source);
+    }
+
+    DYNAMIC_ARRAY_TARGET("avx512f,avx512bw")
+    static void store(void* target, __m512i value) {
+        _mm512_storeu_si512(target, value);
+    }
+
+    DYNAMIC_ARRAY_TARGET("avx512f,avx512bw")
+    static bool differ(__m512i x, __m512i y) {
+        return _mm512_cmpneq_epi8_mask(x, y) != 0;
+    }
+};
+
+template <typename T>
+struct SSE2Ops;
+
+template <typename T>
+struct AVX2Ops;
+
+template <typename T>
+struct AVX512Ops;
+
+template <>
+struct SSE2Ops<int8_t> : SSE2Vector {
+    static const size_t width = 16 / sizeof(int8_t);
+
+    DYNAMIC_ARRAY_TARGET("sse2")
+    static __m128i set1(int value) {
+        return _mm_set1_epi8(static_cast<char>(value));
+    }
+
+    DYNAMIC_ARRAY_TARGET("sse2")
+    static __m128i addSat(__m128i x, __m128i y) {
+        return _mm_adds_epi8(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("sse2")
+    static __m128i subSat(__m128i x, __m128i y) {
+        return _mm_subs_epi8(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("sse2")
+    static __m128i addWrap(__m128i x, __m128i y) {
+        return _mm_add_epi8(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("sse2")
+    static __m128i subWrap(__m128i x, __m128i y) {
+        return _mm_sub_epi8(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("sse2")
+    static __m128i min(__m128i x, __m128i y) {
+        return select(_mm_cmpgt_epi8(x, y), y, x);
+    }
+
+    DYNAMIC_ARRAY_TARGET("sse2")
+    static __m128i max(__m128i x, __m128i y) {
+        return select(_mm_cmpgt_epi8(x, y), x, y);
+    }
+};
+
+template <>
+struct SSE2Ops<uint8_t> : SSE2Vector {
+    static const size_t width = 16 / sizeof(uint8_t);
+
+    DYNAMIC_ARRAY_TARGET("sse2")
+    static __m128i set1(int value) {
+        return _mm_set1_epi8(static_cast<char>(value));
+    }
+
+    DYNAMIC_ARRAY_TARGET("sse2")
+    static __m128i addSat(__m128i x, __m128i y) {
+        return _mm_adds_epu8(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("sse2")
+    static __m128i subSat(__m128i x, __m128i y) {
+        return _mm_subs_epu8(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("sse2")
+    static __m128i addWrap(__m128i x, __m128i y) {
+        return _mm_add_epi8(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("sse2")
+    static __m128i subWrap(__m128i x, __m128i y) {
+        return _mm_sub_epi8(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("sse2")
+    static __m128i min(__m128i x, __m128i y) {
+        return _mm_min_epu8(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("sse2")
+    static __m128i max(__m128i x, __m128i y) {
+        return _mm_max_epu8(x, y);
+    }
+};
+
+template <>
+struct SSE2Ops<int16_t> : SSE2Vector {
+    static const size_t width = 16 / sizeof(int16_t);
+
+    DYNAMIC_ARRAY_TARGET("sse2")
+    static __m128i set1(int value) {
+        return _mm_set1_epi16(static_cast<short>(value));
+    }
+
+    DYNAMIC_ARRAY_TARGET("sse2")
+    static __m128i addSat(__m128i x, __m128i y) {
+        return _mm_adds_epi16(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("sse2")
+    static __m128i subSat(__m128i x, __m128i y) {
+        return _mm_subs_epi16(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("sse2")
+    static __m128i addWrap(__m128i x, __m128i y) {
+        return _mm_add_epi16(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("sse2")
+    static __m128i subWrap(__m128i x, __m128i y) {
+        return _mm_sub_epi16(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("sse2")
+    static __m128i min(__m128i x, __m128i y) {
+        return _mm_min_epi16(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("sse2")
+    static __m128i max(__m128i x, __m128i y) {
+        return _mm_max_epi16(x, y);
+    }
+};
+
+template <>
+struct SSE2Ops<uint16_t> : SSE2Vector {
+    static const size_t width = 16 / sizeof(uint16_t);
+
+    DYNAMIC_ARRAY_TARGET("sse2")
+    static __m128i set1(int value) {
+        return _mm_set1_epi16(static_cast<short>(value));
+    }
+
+    DYNAMIC_ARRAY_TARGET("sse2")
+    static __m128i addSat(__m128i x, __m128i y) {
+        return _mm_adds_epu16(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("sse2")
+    static __m128i subSat(__m128i x, __m128i y) {
+        return _mm_subs_epu16(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("sse2")
+    static __m128i addWrap(__m128i x, __m128i y) {
+        return _mm_add_epi16(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("sse2")
+    static __m128i subWrap(__m128i x, __m128i y) {
+        return _mm_sub_epi16(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("sse2")
+    static __m128i min(__m128i x, __m128i y) {
+        return flipSign16(_mm_min_epi16(flipSign16(x), flipSign16(y)));
+    }
+
+    DYNAMIC_ARRAY_TARGET("sse2")
+    static __m128i max(__m128i x, __m128i y) {
+        return flipSign16(_mm_max_epi16(flipSign16(x), flipSign16(y)));
+    }
+};
+
+template <>
+struct SSE2Ops<int> : SSE2Vector {
+    static const size_t width = 16 / sizeof(int);
+
+    DYNAMIC_ARRAY_TARGET("sse2")
+    static __m128i set1(int value) {
+        return _mm_set1_epi32(value);
+    }
+
+    DYNAMIC_ARRAY_TARGET("sse2")
+    static __m128i addSat(__m128i x, __m128i y) {
+        return _mm_add_epi32(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("sse2")
+    static __m128i subSat(__m128i x, __m128i y) {
+        return _mm_sub_epi32(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("sse2")
+    static __m128i addWrap(__m128i x, __m128i y) {
+        return _mm_add_epi32(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("sse2")
+    static __m128i subWrap(__m128i x, __m128i y) {
+        return _mm_sub_epi32(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("sse2")
+    static __m128i min(__m128i x, __m128i y) {
+        return select(_mm_cmpgt_epi32(x, y), y, x);
+    }
+
+    DYNAMIC_ARRAY_TARGET("sse2")
+    static __m128i max(__m128i x, __m128i y) {
+        return select(_mm_cmpgt_epi32(x, y), x, y);
+    }
+};
+
+template <>
+struct AVX2Ops<int8_t> : AVX2Vector {
+    static const size_t width = 32 / sizeof(int8_t);
+
+    DYNAMIC_ARRAY_TARGET("avx2")
+    static __m256i set1(int value) {
+        return _mm256_set1_epi8(static_cast<char>(value));
+    }
+
+    DYNAMIC_ARRAY_TARGET("avx2")
+    static __m256i addSat(__m256i x, __m256i y) {
+        return _mm256_adds_epi8(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("avx2")
+    static __m256i subSat(__m256i x, __m256i y) {
+        return _mm256_subs_epi8(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("avx2")
+    static __m256i addWrap(__m256i x, __m256i y) {
+        return _mm256_add_epi8(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("avx2")
+    static __m256i subWrap(__m256i x, __m256i y) {
+        return _mm256_sub_epi8(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("avx2")
+    static __m256i min(__m256i x, __m256i y) {
+        return _mm256_min_epi8(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("avx2")
+    static __m256i max(__m256i x, __m256i y) {
+        return _mm256_max_epi8(x, y);
+    }
+};
+
+template <>
+struct AVX2Ops<uint8_t> : AVX2Vector {
+    static const size_t width = 32 / sizeof(uint8_t);
+
+    DYNAMIC_ARRAY_TARGET("avx2")
+    static __m256i set1(int value) {
+        return _mm256_set1_epi8(static_cast<char>(value));
+    }
+
+    DYNAMIC_ARRAY_TARGET("avx2")
+    static __m256i addSat(__m256i x, __m256i y) {
+        return _mm256_adds_epu8(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("avx2")
+    static __m256i subSat(__m256i x, __m256i y) {
+        return _mm256_subs_epu8(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("avx2")
+    static __m256i addWrap(__m256i x, __m256i y) {
+        return _mm256_add_epi8(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("avx2")
+    static __m256i subWrap(__m256i x, __m256i y) {
+        return _mm256_sub_epi8(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("avx2")
+    static __m256i min(__m256i x, __m256i y) {
+        return _mm256_min_epu8(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("avx2")
+    static __m256i max(__m256i x, __m256i y) {
+        return _mm256_max_epu8(x, y);
+    }
+};
+
+template <>
+struct AVX2Ops<int16_t> : AVX2Vector {
+    static const size_t width = 32 / sizeof(int16_t);
+
+    DYNAMIC_ARRAY_TARGET("avx2")
+    static __m256i set1(int value) {
+        return _mm256_set1_epi16(static_cast<short>(value));
+    }
+
+    DYNAMIC_ARRAY_TARGET("avx2")
+    static __m256i addSat(__m256i x, __m256i y) {
+        return _mm256_adds_epi16(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("avx2")
+    static __m256i subSat(__m256i x, __m256i y) {
+        return _mm256_subs_epi16(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("avx2")
+    static __m256i addWrap(__m256i x, __m256i y) {
+        return _mm256_add_epi16(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("avx2")
+    static __m256i subWrap(__m256i x, __m256i y) {
+        return _mm256_sub_epi16(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("avx2")
+    static __m256i min(__m256i x, __m256i y) {
+        return _mm256_min_epi16(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("avx2")
+    static __m256i max(__m256i x, __m256i y) {
+        return _mm256_max_epi16(x, y);
+    }
+};
+
+template <>
+struct AVX2Ops<uint16_t> : AVX2Vector {
+    static const size_t width = 32 / sizeof(uint16_t);
+
+    DYNAMIC_ARRAY_TARGET("avx2")
+    static __m256i set1(int value) {
+        return _mm256_set1_epi16(static_cast<short>(value));
+    }
+
+    DYNAMIC_ARRAY_TARGET("avx2")
+    static __m256i addSat(__m256i x, __m256i y) {
+        return _mm256_adds_epu16(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("avx2")
+    static __m256i subSat(__m256i x, __m256i y) {
+        return _mm256_subs_epu16(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("avx2")
+    static __m256i addWrap(__m256i x, __m256i y) {
+        return _mm256_add_epi16(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("avx2")
+    static __m256i subWrap(__m256i x, __m256i y) {
+        return _mm256_sub_epi16(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("avx2")
+    static __m256i min(__m256i x, __m256i y) {
+        return _mm256_min_epu16(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("avx2")
+    static __m256i max(__m256i x, __m256i y) {
+        return _mm256_max_epu16(x, y);
+    }
+};
+
+template <>
+struct AVX2Ops<int> : AVX2Vector {
+    static const size_t width = 32 / sizeof(int);
+
+    DYNAMIC_ARRAY_TARGET("avx2")
+    static __m256i set1(int value) {
+        return _mm256_set1_epi32(value);
+    }
+
+    DYNAMIC_ARRAY_TARGET("avx2")
+    static __m256i addSat(__m256i x, __m256i y) {
+        return _mm256_add_epi32(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("avx2")
+    static __m256i subSat(__m256i x, __m256i y) {
+        return _mm256_sub_epi32(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("avx2")
+    static __m256i addWrap(__m256i x, __m256i y) {
+        return _mm256_add_epi32(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("avx2")
+    static __m256i subWrap(__m256i x, __m256i y) {
+        return _mm256_sub_epi32(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("avx2")
+    static __m256i min(__m256i x, __m256i y) {
+        return _mm256_min_epi32(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("avx2")
+    static __m256i max(__m256i x, __m256i y) {
+        return _mm256_max_epi32(x, y);
+    }
+};
+
+template <>
+struct AVX512Ops<int8_t> : AVX512Vector {
+    static const size_t width = 64 / sizeof(int8_t);
+
+    DYNAMIC_ARRAY_TARGET("avx512f,avx512bw")
+    static __m512i set1(int value) {
+        return _mm512_set1_epi8(static_cast<char>(value));
+    }
 
+    DYNAMIC_ARRAY_TARGET("avx512f,avx512bw")
+    static __m512i addSat(__m512i x, __m512i y) {
+        return _mm512_adds_epi8(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("avx512f,avx512bw")
+    static __m512i subSat(__m512i x, __m512i y) {
+        return _mm512_subs_epi8(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("avx512f,avx512bw")
+    static __m512i addWrap(__m512i x, __m512i y) {
+        return _mm512_add_epi8(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("avx512f,avx512bw")
+    static __m512i subWrap(__m512i x, __m512i y) {
+        return _mm512_sub_epi8(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("avx512f,avx512bw")
+    static __m512i min(__m512i x, __m512i y) {
+        return _mm512_min_epi8(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("avx512f,avx512bw")
+    static __m512i max(__m512i x, __m512i y) {
+        return _mm512_max_epi8(x, y);
+    }
+};
+
+template <>
+struct AVX512Ops<uint8_t> : AVX512Vector {
+    static const size_t width = 64 / sizeof(uint8_t);
+
+    DYNAMIC_ARRAY_TARGET("avx512f,avx512bw")
+    static __m512i set1(int value) {
+        return _mm512_set1_epi8(static_cast<char>(value));
+    }
+
+    DYNAMIC_ARRAY_TARGET("avx512f,avx512bw")
+    static __m512i addSat(__m512i x, __m512i y) {
+        return _mm512_adds_epu8(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("avx512f,avx512bw")
+    static __m512i subSat(__m512i x, __m512i y) {
+        return _mm512_subs_epu8(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("avx512f,avx512bw")
+    static __m512i addWrap(__m512i x, __m512i y) {
+        return _mm512_add_epi8(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("avx512f,avx512bw")
+    static __m512i subWrap(__m512i x, __m512i y) {
+        return _mm512_sub_epi8(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("avx512f,avx512bw")
+    static __m512i min(__m512i x, __m512i y) {
+        return _mm512_min_epu8(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("avx512f,avx512bw")
+    static __m512i max(__m512i x, __m512i y) {
+        return _mm512_max_epu8(x, y);
+    }
+};
+
+template <>
+struct AVX512Ops<int16_t> : AVX512Vector {
+    static const size_t width = 64 / sizeof(int16_t);
+
+    DYNAMIC_ARRAY_TARGET("avx512f,avx512bw")
+    static __m512i set1(int value) {
+        return _mm512_set1_epi16(static_cast<short>(value));
+    }
+
+    DYNAMIC_ARRAY_TARGET("avx512f,avx512bw")
+    static __m512i addSat(__m512i x, __m512i y) {
+        return _mm512_adds_epi16(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("avx512f,avx512bw")
+    static __m512i subSat(__m512i x, __m512i y) {
+        return _mm512_subs_epi16(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("avx512f,avx512bw")
+    static __m512i addWrap(__m512i x, __m512i y) {
+        return _mm512_add_epi16(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("avx512f,avx512bw")
+    static __m512i subWrap(__m512i x, __m512i y) {
+        return _mm512_sub_epi16(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("avx512f,avx512bw")
+    static __m512i min(__m512i x, __m512i y) {
+        return _mm512_min_epi16(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("avx512f,avx512bw")
+    static __m512i max(__m512i x, __m512i y) {
+        return _mm512_max_epi16(x, y);
+    }
+};
+
+template <>
+struct AVX512Ops<uint16_t> : AVX512Vector {
+    static const size_t width = 64 / sizeof(uint16_t);
+
+    DYNAMIC_ARRAY_TARGET("avx512f,avx512bw")
+    static __m512i set1(int value) {
+        return _mm512_set1_epi16(static_cast<short>(value));
+    }
+
+    DYNAMIC_ARRAY_TARGET("avx512f,avx512bw")
+    static __m512i addSat(__m512i x, __m512i y) {
+        return _mm512_adds_epu16(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("avx512f,avx512bw")
+    static __m512i subSat(__m512i x, __m512i y) {
+        return _mm512_subs_epu16(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("avx512f,avx512bw")
+    static __m512i addWrap(__m512i x, __m512i y) {
+        return _mm512_add_epi16(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("avx512f,avx512bw")
+    static __m512i subWrap(__m512i x, __m512i y) {
+        return _mm512_sub_epi16(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("avx512f,avx512bw")
+    static __m512i min(__m512i x, __m512i y) {
+        return _mm512_min_epu16(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("avx512f,avx512bw")
+    static __m512i max(__m512i x, __m512i y) {
+        return _mm512_max_epu16(x, y);
+    }
+};
+
+template <>
+struct AVX512Ops<int> : AVX512Vector {
+    static const size_t width = 64 / sizeof(int);
+
+    DYNAMIC_ARRAY_TARGET("avx512f,avx512bw")
+    static __m512i set1(int value) {
+        return _mm512_set1_epi32(value);
+    }
+
+    DYNAMIC_ARRAY_TARGET("avx512f,avx512bw")
+    static __m512i addSat(__m512i x, __m512i y) {
+        return _mm512_add_epi32(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("avx512f,avx512bw")
+    static __m512i subSat(__m512i x, __m512i y) {
+        return _mm512_sub_epi32(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("avx512f,avx512bw")
+    static __m512i addWrap(__m512i x, __m512i y) {
+        return _mm512_add_epi32(x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("avx512f,avx512bw")
+    static __m512i subWrap(__m512i x, __m512i y) {
+        return _mm512_sub_epi32(x, y);
+    }
+
+    // Full-mask maskz forms compile to the same vpminsd/vpmaxsd but avoid
+    // GCC's false -Wmaybe-uninitialized from _mm512_undefined_epi32
+    DYNAMIC_ARRAY_TARGET("avx512f,avx512bw")
+    static __m512i min(__m512i x, __m512i y) {
+        return _mm512_maskz_min_epi32(0xFFFF, x, y);
+    }
+
+    DYNAMIC_ARRAY_TARGET("avx512f,avx512bw")
+    static __m512i max(__m512i x, __m512i y) {
+        return _mm512_maskz_max_epi32(0xFFFF, x, y);
+    }
+};
+
+template <typename Domain, bool Subtract>
+DYNAMIC_ARRAY_TARGET("sse2")
+void combineSSE2(const typename Domain::StorageType* a, const typename Domain::StorageType* b,
+               typename Domain::StorageType* out, size_t count) {
+    typedef SSE2Ops<typename Domain::StorageType> Ops;
+    size_t i = 0;
+    if (Domain::policy != OverflowPolicy::Wrap || Domain::fullRange) {
+        const typename Ops::Vector low = Ops::set1(Domain::minValue);
+        const typename Ops::Vector high = Ops::set1(Domain::maxValue);
+        for (; i + Ops::width <= count; i += Ops::width) {
+            typename Ops::Vector x = Ops::load(a + i);
+            typename Ops::Vector y = Ops::load(b + i);
+            typename Ops::Vector exact = Subtract ? Ops::subWrap(x, y) : Ops::addWrap(x, y);
+            typename Ops::Vector value = exact;
+            if (Domain::policy != OverflowPolicy::Wrap) {
+                value = Subtract ? Ops::subSat(x, y) : Ops::addSat(x, y);
+                if (!Domain::fullRange) {
+                    value = Ops::min(Ops::max(value, low), high);
+                }
+            }
+            if (Domain::policy == OverflowPolicy::Throw && Ops::differ(value, exact)) {
+                throwOverflow<Domain>();
+            }
+            Ops::store(out + i, value);
+        }
+    }
+    combineScalar<Domain, Subtract>(a + i, b + i, out + i, count - i);
+}
+
+template <typename Domain, bool Subtract>
+DYNAMIC_ARRAY_TARGET("avx2")
+void combineAVX2(const typename Domain::StorageType* a, const typename Domain::StorageType* b,
+               typename Domain::StorageType* out, size_t count) {
+    typedef AVX2Ops<typename Domain::StorageType> Ops;
+    size_t i = 0;
+    if (Domain::policy != OverflowPolicy::Wrap || Domain::fullRange) {
+        const typename Ops::Vector low = Ops::set1(Domain::minValue);
+        const typename Ops::Vector high = Ops::set1(Domain::maxValue);
+        for (; i + Ops::width <= count; i += Ops::width) {
+            typename Ops::Vector x = Ops::load(a + i);
+            typename Ops::Vector y = Ops::load(b + i);
+            typename Ops::Vector exact = Subtract ? Ops::subWrap(x, y) : Ops::addWrap(x, y);
+            typename Ops::Vector value = exact;
+            if (Domain::policy != OverflowPolicy::Wrap) {
+                value = Subtract ? Ops::subSat(x, y) : Ops::addSat(x, y);
+                if (!Domain::fullRange) {
+                    value = Ops::min(Ops::max(value, low), high);
+                }
+            }
+            if (Domain::policy == OverflowPolicy::Throw && Ops::differ(value, exact)) {
+                throwOverflow<Domain>();
+            }
+            Ops::store(out + i, value);
+        }
+    }
+    combineScalar<Domain, Subtract>(a + i, b + i, out + i, count - i);
+}
+
+template <typename Domain, bool Subtract>
+DYNAMIC_ARRAY_TARGET("avx512f,avx512bw")
+void combineAVX512(const typename Domain::StorageType* a, const typename Domain::StorageType* b,
+               typename Domain::StorageType* out, size_t count) {
+    typedef AVX512Ops<typename Domain::StorageType> Ops;
+    size_t i = 0;
+    if (Domain::policy != OverflowPolicy::Wrap || Domain::fullRange) {
+        const typename Ops::Vector low = Ops::set1(Domain::minValue);
+        const typename Ops::Vector high = Ops::set1(Domain::maxValue);
+        for (; i + Ops::width <= count; i += Ops::width) {
+            typename Ops::Vector x = Ops::load(a + i);
+            typename Ops::Vector y = Ops::load(b + i);
+            typename Ops::Vector exact = Subtract ? Ops::subWrap(x, y) : Ops::addWrap(x, y);
+            typename Ops::Vector value = exact;
+            if (Domain::policy != OverflowPolicy::Wrap) {
+                value = Subtract ? Ops::subSat(x, y) : Ops::addSat(x, y);
+                if (!Domain::fullRange) {
+                    value = Ops::min(Ops::max(value, low), high);
+                }
+            }
+            if (Domain::policy == OverflowPolicy::Throw && Ops::differ(value, exact)) {
+                throwOverflow<Domain>();
+            }
+            Ops::store(out + i, value);
+        }
+    }
+    combineScalar<Domain, Subtract>(a + i, b + i, out + i, count - i);
+}
+
+#endif
+
+// AVX512 here means AVX-512F together with AVX-512BW (needed for the 8/16-bit kernels)
+enum class SimdLevel { Scalar, SSE2, AVX2, AVX512 };
+
+inline SimdLevel detectSimdLevel() {
+#if !defined(DYNAMIC_ARRAY_X86)
+    return SimdLevel::Scalar;
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    int maxLeaf = info[0];
+    __cpuid(info, 1);
+    bool sse2 = (info[3] & (1 << 26)) != 0;
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    if (osxsave && avx && maxLeaf >= 7) {
+        unsigned long long xcr0 = _xgetbv(0);
+        __cpuidex(info, 7, 0);
+        if ((xcr0 & 0xE6) == 0xE6 && (info[1] & (1 << 16)) != 0 && (info[1] & (1 << 30)) != 0) {
+            return SimdLevel::AVX512;
+        }
+        if ((xcr0 & 0x6) == 0x6 && (info[1] & (1 << 5)) != 0) {
+            return SimdLevel::AVX2;
+        }
+    }
+    return sse2 ? SimdLevel::SSE2 : SimdLevel::Scalar;
+#else
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) {
+        return SimdLevel::AVX512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return SimdLevel::AVX2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return SimdLevel::SSE2;
+    }
+    return SimdLevel::Scalar;
+#endif
+}
+
+template <typename Domain, bool Subtract>
+CombineKernel<Domain> selectCombineKernel() {
+    static const SimdLevel level = detectSimdLevel();
+    switch (level) {
+#ifdef DYNAMIC_ARRAY_X86
+        case SimdLevel::AVX512:
+            return combineAVX512<Domain, Subtract>;
+        case SimdLevel::AVX2:
+            return combineAVX2<Domain, Subtract>;
+        case SimdLevel::SSE2:
+            return combineSSE2<Domain, Subtract>;
+#endif
+        default:
+            return combineScalar<Domain, Subtract>;
+    }
+}
+
+// Index of the first value outside [Min, Max], or count if all are valid.
+// The vector versions track the minimum and maximum of each block and scan
+// element by element only inside a block that has a bad value.
+typedef size_t (*RangeCheckKernel)(const int* values, size_t count);
+
+static const size_t rangeCheckBlock = 1024;
+
+template <int Min, int Max>
+size_t findOutOfRangeScalar(const int* values, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        if (values[i] < Min || values[i] > Max) {
+            return i;
+        }
+    }
+    return count;
+}
+
+#ifdef DYNAMIC_ARRAY_X86
+template <int Min, int Max>
+DYNAMIC_ARRAY_TARGET("sse2")
+size_t findOutOfRangeSSE2(const int* values, size_t count) {
+    const __m128i low = _mm_set1_epi32(Min);
+    const __m128i high = _mm_set1_epi32(Max);
+    size_t begin = 0;
+    for (; begin + rangeCheckBlock <= count; begin += rangeCheckBlock) {
+        __m128i bad = _mm_setzero_si128();
+        for (size_t i = begin; i < begin + rangeCheckBlock; i += 4) {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+            bad = _mm_or_si128(bad, _mm_or_si128(_mm_cmplt_epi32(x, low), _mm_cmpgt_epi32(x, high)));
+        }
+        if (_mm_movemask_epi8(bad) != 0) {
+            return begin + findOutOfRangeScalar<Min, Max>(values + begin, rangeCheckBlock);
+        }
+    }
+    return begin + findOutOfRangeScalar<Min, Max>(values + begin, count - begin);
+}
+
+template <int Min, int Max>
+DYNAMIC_ARRAY_TARGET("avx2")
+size_t findOutOfRangeAVX2(const int* values, size_t count) {
+    const __m256i low = _mm256_set1_epi32(Min);
+    const __m256i high = _mm256_set1_epi32(Max);
+    size_t begin = 0;
+    for (; begin + rangeCheckBlock <= count; begin += rangeCheckBlock) {
+        __m256i minimum = _mm256_setzero_si256();
+        __m256i maximum = _mm256_setzero_si256();
+        for (size_t i = begin; i < begin + rangeCheckBlock; i += 8) {
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+            minimum = _mm256_min_epi32(minimum, x);
+            maximum = _mm256_max_epi32(maximum, x);
+        }
+        __m256i bad = _mm256_or_si256(_mm256_cmpgt_epi32(low, minimum), _mm256_cmpgt_epi32(maximum, high));
+        if (!_mm256_testz_si256(bad, bad)) {
+            return begin + findOutOfRangeScalar<Min, Max>(values + begin, rangeCheckBlock);
+        }
+    }
+    return begin + findOutOfRangeScalar<Min, Max>(values + begin, count - begin);
+}
+
+template <int Min, int Max>
+DYNAMIC_ARRAY_TARGET("avx512f")
+size_t findOutOfRangeAVX512(const int* values, size_t count) {
+    const __m512i low = _mm512_set1_epi32(Min);
+    const __m512i high = _mm512_set1_epi32(Max);
+    size_t begin = 0;
+    for (; begin + rangeCheckBlock <= count; begin += rangeCheckBlock) {
+        // Accumulate the compare masks directly; a min/max reduction through
+        // _mm512_min_epi32 trips a false -Wmaybe-uninitialized in GCC
+        __mmask16 outside = 0;
+        for (size_t i = begin; i < begin + rangeCheckBlock; i += 16) {
+            __m512i x = _mm512_loadu_si512(values + i);
+            outside |= _mm512_cmplt_epi32_mask(x, low) | _mm512_cmpgt_epi32_mask(x, high);
+        }
+        if (outside != 0) {
+            return begin + findOutOfRangeScalar<Min, Max>(values + begin, rangeCheckBlock);
+        }
+    }
+    return begin + findOutOfRangeScalar<Min, Max>(values + begin, count - begin);
+}
+#endif
+
+template <int Min, int Max>
+RangeCheckKernel selectRangeCheckKernel() {
+    static const SimdLevel level = detectSimdLevel();
+    switch (level) {
+#ifdef DYNAMIC_ARRAY_X86
+        case SimdLevel::AVX512:
+            return findOutOfRangeAVX512<Min, Max>;
+        case SimdLevel::AVX2:
+            return findOutOfRangeAVX2<Min, Max>;
+        case SimdLevel::SSE2:
+            return findOutOfRangeSSE2<Min, Max>;
+#endif
+        default:
+            return findOutOfRangeScalar<Min, Max>;
+    }
+}
+
+// Persistent worker pool for the parallel overloads. parallelFor splits
+// [0, count) into chunks that the workers and the calling thread pull from
+// a shared counter; it blocks until every chunk is done. If a task throws,
+// the remaining chunks still run and the first exception is rethrown on the
+// calling thread once every helper has finished. Tasks must not call
+// parallelFor on the same pool.
+class ThreadPool {
 public:
-    DynamicArray(size_t arraySize) : size(arraySize) {
-        if (size > 0) {
-            data = new int[size];
-            for (size_t i = 0; i < size; ++i) {
-                data[i] = 0;
+    explicit ThreadPool(size_t threadCount = std::thread::hardware_concurrency()) : stopping(false) {
+        for (size_t i = 1; i < threadCount; ++i) {
+            workers.emplace_back([this] { workerLoop(); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (size_t i = 0; i < workers.size(); ++i) {
+            workers[i].join();
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    static ThreadPool& shared() {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    size_t getThreadCount() const {
+        return workers.size() + 1;
+    }
+
+    template <typename Task>
+    void parallelFor(size_t count, size_t chunkSize, const Task& task) {
+        if (count == 0) {
+            return;
+        }
+        if (chunkSize == 0) {
+            chunkSize = 1;
+        }
+        size_t chunks = (count + chunkSize - 1) / chunkSize;
+        size_t helpers = (workers.size() < chunks) ? workers.size() : chunks - 1;
+        if (helpers == 0) {
+            task(0, count);
+            return;
+        }
+
+        std::atomic<size_t> nextChunk(0);
+        std::exception_ptr failure;
+        std::mutex failureMutex;
+        auto runChunks = [&] {
+            for (size_t chunk = nextChunk++; chunk < chunks; chunk = nextChunk++) {
+                size_t begin = chunk * chunkSize;
+                size_t end = (begin + chunkSize < count) ? begin + chunkSize : count;
+                try {
+                    task(begin, end);
+                } catch (...) {
+                    std::lock_guard<std::mutex> failureLock(failureMutex);
+                    if (!failure) {
+                        failure = std::current_exception();
+                    }
+                }
+            }
+        };
+
+        size_t finished = 0;
+        std::condition_variable done;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (size_t i = 0; i < helpers; ++i) {
+                jobs.push_back([&] {
+                    runChunks();
+                    std::lock_guard<std::mutex> doneLock(mutex);
+                    if (++finished == helpers) {
+                        done.notify_one();
+                    }
+                });
+            }
+        }
+        wake.notify_all();
+
+        runChunks();
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            done.wait(lock, [&] { return finished == helpers; });
+        }
+        if (failure) {
+            std::rethrow_exception(failure);
+        }
+    }
+
+private:
+    void workerLoop() {
+        for (;;) {
+            std::function<void()> job;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this] { return stopping || !jobs.empty(); });
+                if (jobs.empty()) {
+                    return;
+                }
+                job = std::move(jobs.front());
+                jobs.pop_front();
+            }
+            job();
+        }
+    }
+
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> jobs;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping;
+};
+
+// Execution policy for the parallel overloads: arrays shorter than
+// serialThreshold run on the calling thread, larger ones are split into
+// chunkSize-element pieces on the given pool.
+struct ParallelPolicy {
+    ThreadPool* pool;
+    size_t chunkSize;
+    size_t serialThreshold;
+
+    ParallelPolicy(ThreadPool& threadPool = ThreadPool::shared(),
+                   size_t chunk = size_t(1) << 16, size_t threshold = size_t(1) << 18)
+        : pool(&threadPool), chunkSize(chunk), serialThreshold(threshold) {}
+
+    template <typename Task>
+    void run(size_t count, const Task& task) const {
+        if (count < serialThreshold) {
+            if (count > 0) {
+                task(0, count);
             }
         } else {
-            data = nullptr;
+            pool->parallelFor(count, chunkSize, task);
         }
     }
+};
+
+template <typename Domain>
+class BasicDynamicArray;
+
+// Page backing for large buffers. HugePages asks for 2 MiB pages: an
+// explicit MAP_HUGETLB mapping first, then transparent huge pages through
+// madvise, and ordinary pages if neither is available.
+enum class PageBacking { Normal, HugePages };
+
+// Tag for constructors whose caller overwrites every element anyway
+struct Uninitialized {};
+
+// Buffers of at least this many bytes are mapped straight from the OS.
+// Fresh anonymous pages are already zero and are committed only on the
+// first write, so a large zero array costs nothing until it is used.
+const size_t lazyZeroThreshold = size_t(1) << 20;
+const size_t hugePageSize = size_t(2) << 20;
+
+// Anonymous zeroed mapping of at least bytes bytes. Returns nullptr when
+// mapping is not supported or fails; the caller then uses calloc/malloc.
+// obtained is HugePages only if the huge pages were actually granted: a
+// MAP_HUGETLB mapping, or a mapping the kernel accepted MADV_HUGEPAGE for.
+// The latter is the transparent huge page path, where the kernel still
+// backs each aligned 2 MiB range with a huge page only when it has one free.
+inline void* mapZeroedPages(size_t bytes, PageBacking backing, size_t& mappedBytes,
+                            PageBacking& obtained) {
+    obtained = PageBacking::Normal;
+#ifdef DYNAMIC_ARRAY_MMAP
+#ifdef MAP_HUGETLB
+    if (backing == PageBacking::HugePages) {
+        size_t length = (bytes + hugePageSize - 1) / hugePageSize * hugePageSize;
+        void* block = mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (block != MAP_FAILED) {
+            mappedBytes = length;
+            obtained = PageBacking::HugePages;
+            return block;
+        }
+    }
+#endif
+    void* block = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (block == MAP_FAILED) {
+        return nullptr;
+    }
+#ifdef MADV_HUGEPAGE
+    if (backing == PageBacking::HugePages && madvise(block, bytes, MADV_HUGEPAGE) == 0) {
+        obtained = PageBacking::HugePages;
+    }
+#endif
+    mappedBytes = bytes;
+    return block;
+#else
+    (void)bytes;
+    (void)backing;
+    (void)mappedBytes;
+    return nullptr;
+#endif
+}
+
+inline void unmapPages(void* block, size_t mappedBytes) {
+#ifdef DYNAMIC_ARRAY_MMAP
+    munmap(block, mappedBytes);
+#else
+    (void)block;
+    (void)mappedBytes;
+#endif
+}
+
+// Lazy a + b / a - b node. Chains such as a + b - c + d build a tree of
+// these without touching the data; the whole tree is evaluated block by
+// block into the destination when it is converted to an array. Every node
+// still applies the overflow policy to its own result, so values match the
+// eager add/subtract.
+// Arrays are held by reference and must outlive the expression.
+template <typename Left, typename Right, bool Subtract>
+class SaturatingExpression {
+public:
+    typedef typename Left::DomainType DomainType;
+    typedef typename DomainType::StorageType ElementType;
+    static_assert(std::is_same<DomainType, typename Right::DomainType>::value,
+                  "Operands must use the same value domain");
+
+    static const size_t blockSize = 1024;
+
+    SaturatingExpression(const Left& leftOperand, const Right& rightOperand)
+        : left(leftOperand), right(rightOperand) {}
+
+    size_t getSize() const {
+        size_t leftSize = left.getSize();
+        size_t rightSize = right.getSize();
+        return (leftSize > rightSize) ? leftSize : rightSize;
+    }
+
+    // The result asks for huge pages if any operand did
+    PageBacking requestedPageBacking() const {
+        return (left.requestedPageBacking() == PageBacking::HugePages ||
+                right.requestedPageBacking() == PageBacking::HugePages) ? PageBacking::HugePages
+                                                                         : PageBacking::Normal;
+    }
+
+    void evaluateInto(ElementType* out) const {
+        size_t count = getSize();
+        for (size_t begin = 0; begin < count; begin += blockSize) {
+            size_t end = (begin + blockSize < count) ? begin + blockSize : count;
+            evaluateBlock(begin, end, out + begin);
+        }
+    }
+
+    // Writes elements [begin, end) of the result to out; end - begin <= blockSize
+    void evaluateBlock(size_t begin, size_t end, ElementType* out) const {
+        ElementType scratch[blockSize];
+        const ElementType* leftBlock = operandBlock(left, begin, end, out);
+        const ElementType* rightBlock = operandBlock(right, begin, end, scratch);
+        selectCombineKernel<DomainType, Subtract>()(leftBlock, rightBlock, out, end - begin);
+    }
+
+private:
+    // Positions past the end of a shorter array read as zero
+    static const ElementType* operandBlock(const BasicDynamicArray<DomainType>& array,
+                                           size_t begin, size_t end, ElementType* scratch) {
+        size_t arraySize = array.getSize();
+        const ElementType* arrayData = array.getData();
+        if (end <= arraySize) {
+            return arrayData + begin;
+        }
+        size_t i = begin;
+        for (; i < arraySize; ++i) {
+            scratch[i - begin] = arrayData[i];
+        }
+        for (; i < end; ++i) {
+            scratch[i - begin] = 0;
+        }
+        return scratch;
+    }
+
+    template <typename L, typename R, bool S>
+    static const ElementType* operandBlock(const SaturatingExpression<L, R, S>& expression,
+                                           size_t begin, size_t end, ElementType* scratch) {
+        expression.evaluateBlock(begin, end, scratch);
+        return scratch;
+    }
+
+    // Sub-expressions are stored by value, arrays by reference
+    template <typename T>
+    struct Stored {
+        typedef const T& type;
+    };
+
+    template <typename L, typename R, bool S>
+    struct Stored<SaturatingExpression<L, R, S> > {
+        typedef SaturatingExpression<L, R, S> type;
+    };
+
+    typename Stored<Left>::type left;
+    typename Stored<Right>::type right;
+};
+
+template <typename T>
+struct IsSaturatingExpression : std::false_type {};
+
+template <typename L, typename R, bool S>
+struct IsSaturatingExpression<SaturatingExpression<L, R, S> > : std::true_type {};
+
+// True for BasicDynamicArray, its subclasses and SaturatingExpression
+template <typename T, typename = void>
+struct IsArrayOperand : std::false_type {};
+
+template <typename T>
+struct IsArrayOperand<T, std::void_t<typename T::DomainType> >
+    : std::integral_constant<bool, std::is_base_of<BasicDynamicArray<typename T::DomainType>, T>::value ||
+                                   IsSaturatingExpression<T>::value> {};
+
+template <typename Left, typename Right,
+          typename = typename std::enable_if<IsArrayOperand<Left>::value && IsArrayOperand<Right>::value>::type>
+SaturatingExpression<Left, Right, false> operator+(const Left& left, const Right& right) {
+    return SaturatingExpression<Left, Right, false>(left, right);
+}
+
+template <typename Left, typename Right,
+          typename = typename std::enable_if<IsArrayOperand<Left>::value && IsArrayOperand<Right>::value>::type>
+SaturatingExpression<Left, Right, true> operator-(const Left& left, const Right& right) {
+    return SaturatingExpression<Left, Right, true>(left, right);
+}
+
+// Domain is a ValueDomain: the value bounds, the overflow policy of
+// add/subtract and the storage type. The public interface always takes and
+// returns int.
+template <typename Domain>
+class BasicDynamicArray {
+protected:
+    typedef typename Domain::StorageType Element;
+
+    Element* data;
+    size_t size;
+    size_t allocated;
+
+    template <typename D>
+    friend class BasicConcurrentDynamicArray;
+
+public:
+    typedef Domain DomainType;
+    typedef Element ElementType;
+
+    // The buffer comes back zeroed from calloc or the OS, so no element is
+    // written here; see lazyZeroThreshold
+    BasicDynamicArray(size_t arraySize, PageBacking backing = PageBacking::Normal)
+        : size(arraySize), allocated(arraySize) {
+        data = allocateElements(size, true, backing);
+    }
+
+    BasicDynamicArray(size_t arraySize, Uninitialized, PageBacking backing = PageBacking::Normal)
+        : size(arraySize), allocated(arraySize) {
+        data = allocateElements(size, false, backing);
+    }
+
+    // Copies share the buffer (copy-on-write): only the reference count is
+    // bumped, and the first write through either copy duplicates the buffer
+    BasicDynamicArray(const BasicDynamicArray& other)
+        : data(other.data), size(other.size), allocated(other.allocated) {
+        retainElements(data);
+    }
+
+    BasicDynamicArray(BasicDynamicArray&& other) noexcept
+        : data(other.data), size(other.size), allocated(other.allocated) {
+        other.data = nullptr;
+        other.size = 0;
+        other.allocated = 0;
+    }
 
-    DynamicArray(const DynamicArray& other) : size(other.size) {
-        if (size > 0) {
-            data = new int[size];
-            for (size_t i = 0; i < size; ++i) {
-                data[i] = other.data[i];
-            }
-        } else {
-            data = nullptr;
+    // Evaluates a lazy a + b - c ... chain in one fused pass
+    template <typename Left, typename Right, bool Subtract>
+    BasicDynamicArray(const SaturatingExpression<Left, Right, Subtract>& expression)
+        : size(expression.getSize()), allocated(expression.getSize()) {
+        data = allocateElements(size, false, expression.requestedPageBacking());
+        // With OverflowPolicy::Throw evaluation can throw; the destructor
+        // of a half-built array never runs, so the buffer is freed here
+        try {
+            expression.evaluateInto(data);
+        } catch (...) {
+            releaseElements(data);
+            throw;
         }
     }
 
-    ~DynamicArray() {
-        delete[] data;
+    ~BasicDynamicArray() {
+        releaseElements(data);
     }
 
     void print() const {
         std::cout << "Array [size: " << size << "]: ";
         for (size_t i = 0; i < size; ++i) {
-            std::cout << data[i];
+            std::cout << static_cast<int>(data[i]);
             if (i < size - 1) {
                 std::cout << ", ";
             }
@@ -49,10 +1461,11 @@ public:
         if (index >= size) {
             throw std::out_of_range("Index is out of array bounds");
         }
-        if (value < -100 || value > 100) {
-            throw std::invalid_argument("Value must be in range from -100 to 100");
+        if (!Domain::contains(value)) {
+            throw std::invalid_argument("Value must be in range " + Domain::rangeText());
         }
-        data[index] = value;
+        makeUnique();
+        data[index] = static_cast<Element>(value);
     }
     
     int getValue(size_t index) const {
@@ -62,56 +1475,156 @@ public:
         return data[index];
     }
 
+    // Unchecked read access for hot loops; input still goes through
+    // setValue/getValue. Only const access is given out, so the value range
+    // and the histogram of the extended array cannot be bypassed.
+    typedef const Element* const_iterator;
+    typedef const_iterator iterator;
+
+    int operator[](size_t index) const {
+        return data[index];
+    }
+
+    const Element* getData() const {
+        return data;
+    }
+
+    const_iterator begin() const {
+        return data;
+    }
+
+    const_iterator end() const {
+        return data + size;
+    }
+
+#ifdef __cpp_lib_span
+    std::span<const Element> view() const {
+        return std::span<const Element>(data, size);
+    }
+#endif
+
     void pushBack(int value) {
-        if (value < -100 || value > 100) {
-            throw std::invalid_argument("Value must be in range from -100 to 100");
+        if (!Domain::contains(value)) {
+            throw std::invalid_argument("Value must be in range " + Domain::rangeText());
+        }
+
+        if (size == allocated) {
+            reserve(allocated > 0 ? allocated * 2 : 1);
+        } else {
+            makeUnique();
         }
+        data[size++] = static_cast<Element>(value);
+    }
 
-        size_t newSize = size + 1;
-        int* newData = new int[newSize];
+    void reserve(size_t newCapacity) {
+        if (newCapacity <= allocated) {
+            return;
+        }
 
+        Element* newData = allocateElements(newCapacity, false, requestedPageBacking());
         for (size_t i = 0; i < size; ++i) {
             newData[i] = data[i];
         }
 
-        newData[size] = value;
-        delete[] data;
+        releaseElements(data);
         data = newData;
-        size = newSize;
+        allocated = newCapacity;
     }
 
-    DynamicArray add(const DynamicArray& other) const {
-        size_t maxSize = (size > other.size) ? size : other.size;
-        DynamicArray result(maxSize);
+    void shrinkToFit() {
+        if (allocated == size) {
+            return;
+        }
+
+        Element* newData = allocateElements(size, false, requestedPageBacking());
+        for (size_t i = 0; i < size; ++i) {
+            newData[i] = data[i];
+        }
+
+        releaseElements(data);
+        data = newData;
+        allocated = size;
+    }
+
+    // Bulk input: the whole buffer is validated in one vector pass before
+    // anything is modified, so on error the array is left unchanged. At most
+    // one reallocation. The buffer must not point into this array.
+    void appendRange(const int* values, size_t count) {
+        checkRange(values, count);
+        if (size + count > allocated) {
+            size_t grown = allocated * 2;
+            reserve((grown > size + count) ? grown : size + count);
+        } else {
+            makeUnique();
+        }
+        for (size_t i = 0; i < count; ++i) {
+            data[size + i] = static_cast<Element>(values[i]);
+        }
+        size += count;
+    }
+
+    // Replaces the contents with [first, last)
+    void assign(const int* first, const int* last) {
+        size_t count = static_cast<size_t>(last - first);
+        checkRange(first, count);
+        if (count > allocated || isShared()) {
+            // The old contents are discarded, so a shared buffer is
+            // replaced rather than duplicated
+            size_t newCapacity = (count > allocated) ? count : allocated;
+            Element* newData = allocateElements(newCapacity, false, requestedPageBacking());
+            releaseElements(data);
+            data = newData;
+            allocated = newCapacity;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            data[i] = static_cast<Element>(first[i]);
+        }
+        size = count;
+    }
 
-        for (size_t i = 0; i < maxSize; ++i) {
-            int value1 = (i < size) ? data[i] : 0;
-            int value2 = (i < other.size) ? other.data[i] : 0;
-            int sum = value1 + value2;
-            
-            if (sum < -100) sum = -100;
-            if (sum > 100) sum = 100;
-            
-            result.data[i] = sum;
+    // Sets every element to value
+    void fill(int value) {
+        if (!Domain::contains(value)) {
+            throw std::invalid_argument("Value must be in range " + Domain::rangeText());
+        }
+        makeUnique();
+        for (size_t i = 0; i < size; ++i) {
+            data[i] = static_cast<Element>(value);
         }
+    }
+
+    BasicDynamicArray add(const BasicDynamicArray& other) const {
+        size_t maxSize = (size > other.size) ? size : other.size;
+        BasicDynamicArray result(maxSize, Uninitialized(), requestedPageBacking());
+        combineInto<false>(other, result);
 
         return result;
     }
 
-    DynamicArray subtract(const DynamicArray& other) const {
+    BasicDynamicArray subtract(const BasicDynamicArray& other) const {
         size_t maxSize = (size > other.size) ? size : other.size;
-        DynamicArray result(maxSize);
+        BasicDynamicArray result(maxSize, Uninitialized(), requestedPageBacking());
+        combineInto<true>(other, result);
 
-        for (size_t i = 0; i < maxSize; ++i) {
-            int value1 = (i < size) ? data[i] : 0;
-            int value2 = (i < other.size) ? other.data[i] : 0;
-            int diff = value1 - value2;
-            
-            if (diff < -100) diff = -100;
-            if (diff > 100) diff = 100;
-            
-            result.data[i] = diff;
-        }
+        return result;
+    }
+
+    BasicDynamicArray add(const BasicDynamicArray& other, const ParallelPolicy& policy) const {
+        size_t maxSize = (size > other.size) ? size : other.size;
+        BasicDynamicArray result(maxSize, Uninitialized(), requestedPageBacking());
+        policy.run(maxSize, [&](size_t begin, size_t end) {
+            combineRange<false>(other, result, begin, end);
+        });
+
+        return result;
+    }
+
+    BasicDynamicArray subtract(const BasicDynamicArray& other, const ParallelPolicy& policy) const {
+        size_t maxSize = (size > other.size) ? size : other.size;
+        BasicDynamicArray result(maxSize, Uninitialized(), requestedPageBacking());
+        policy.run(maxSize, [&](size_t begin, size_t end) {
+            combineRange<true>(other, result, begin, end);
+        });
 
         return result;
     }
@@ -120,143 +1633,725 @@ public:
         return size;
     }
 
-    DynamicArray& operator=(const DynamicArray& other) {
+    size_t capacity() const {
+        return allocated;
+    }
+
+    // Backing the current buffer actually got; Normal when huge pages were
+    // requested but the buffer fell back to ordinary pages or malloc
+    PageBacking getPageBacking() const {
+        return (data != nullptr) ? headerOf(data)->obtained : PageBacking::Normal;
+    }
+
+    // Backing requested at construction. Results of add/subtract and
+    // reallocations request it again, so a small buffer that grows past
+    // lazyZeroThreshold still gets huge pages.
+    PageBacking requestedPageBacking() const {
+        return (data != nullptr) ? headerOf(data)->requested : PageBacking::Normal;
+    }
+
+    BasicDynamicArray& operator=(const BasicDynamicArray& other) {
         if (this != &other) {
-            delete[] data;
-            size = other.size;
-            if (size > 0) {
-                data = new int[size];
-                for (size_t i = 0; i < size; ++i) {
-                    data[i] = other.data[i];
-                }
+            BasicDynamicArray copy(other);
+            swap(copy);
+        }
+        return *this;
+    }
+
+    BasicDynamicArray& operator=(BasicDynamicArray&& other) noexcept {
+        if (this != &other) {
+            BasicDynamicArray moved(std::move(other));
+            swap(moved);
+        }
+        return *this;
+    }
+
+    template <typename Left, typename Right, bool Subtract>
+    BasicDynamicArray& operator=(const SaturatingExpression<Left, Right, Subtract>& expression) {
+        BasicDynamicArray result(expression);
+        swap(result);
+        return *this;
+    }
+
+    void swap(BasicDynamicArray& other) noexcept {
+        std::swap(data, other.data);
+        std::swap(size, other.size);
+        std::swap(allocated, other.allocated);
+    }
+
+    friend void swap(BasicDynamicArray& a, BasicDynamicArray& b) noexcept {
+        a.swap(b);
+    }
+
+private:
+    // The reference count lives in front of the elements. The decrement is
+    // acq_rel so that whoever frees the buffer sees every other owner's reads.
+    // mappedBytes is the length of the OS mapping, or 0 for malloc memory.
+    struct BufferHeader {
+        std::atomic<size_t> references;
+        size_t mappedBytes;
+        PageBacking requested;
+        PageBacking obtained;
+    };
+
+    static BufferHeader* headerOf(const Element* elements) {
+        return reinterpret_cast<BufferHeader*>(const_cast<Element*>(elements)) - 1;
+    }
+
+    static Element* allocateElements(size_t count, bool zeroed = false,
+                                     PageBacking backing = PageBacking::Normal) {
+        if (count == 0) {
+            return nullptr;
+        }
+        if (count > (SIZE_MAX - sizeof(BufferHeader)) / sizeof(Element)) {
+            throw std::bad_array_new_length();
+        }
+        size_t bytes = sizeof(BufferHeader) + count * sizeof(Element);
+        size_t mappedBytes = 0;
+        PageBacking obtained = PageBacking::Normal;
+        void* block = (bytes >= lazyZeroThreshold) ? mapZeroedPages(bytes, backing, mappedBytes, obtained)
+                                                   : nullptr;
+        if (block == nullptr) {
+            block = zeroed ? std::calloc(1, bytes) : std::malloc(bytes);
+            if (block == nullptr) {
+                throw std::bad_alloc();
+            }
+        }
+        BufferHeader* header = new (block) BufferHeader;
+        header->references.store(1, std::memory_order_relaxed);
+        header->mappedBytes = mappedBytes;
+        header->requested = backing;
+        header->obtained = obtained;
+        return reinterpret_cast<Element*>(header + 1);
+    }
+
+    static void retainElements(Element* elements) {
+        if (elements != nullptr) {
+            headerOf(elements)->references.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    static void releaseElements(Element* elements) {
+        if (elements == nullptr) {
+            return;
+        }
+        BufferHeader* header = headerOf(elements);
+        if (header->references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            size_t mappedBytes = header->mappedBytes;
+            header->~BufferHeader();
+            if (mappedBytes > 0) {
+                unmapPages(header, mappedBytes);
             } else {
-                data = nullptr;
+                std::free(header);
             }
         }
-        return *this;
     }
+
+    bool isShared() const {
+        return data != nullptr && headerOf(data)->references.load(std::memory_order_acquire) > 1;
+    }
+
+    // Called before any write: a shared buffer is duplicated at the same
+    // capacity and this array keeps writing only to its own copy
+    void makeUnique() {
+        if (!isShared()) {
+            return;
+        }
+        Element* newData = allocateElements(allocated, false, requestedPageBacking());
+        std::copy(data, data + size, newData);
+        releaseElements(data);
+        data = newData;
+    }
+
+    static void checkRange(const int* values, size_t count) {
+        size_t bad = selectRangeCheckKernel<Domain::minValue, Domain::maxValue>()(values, count);
+        if (bad < count) {
+            throw std::invalid_argument("Value at index " + std::to_string(bad) + " must be in range " +
+                                        Domain::rangeText());
+        }
+    }
+
+    // The overlapping part goes through the vector kernel; the tail of the
+    // longer operand is copied, negated through the overflow policy for
+    // subtraction (0 - x may leave an asymmetric domain)
+    template <bool Subtract>
+    void combineInto(const BasicDynamicArray& other, BasicDynamicArray& result) const {
+        combineRange<Subtract>(other, result, 0, result.size);
+    }
+
+    template <bool Subtract>
+    void combineRange(const BasicDynamicArray& other, BasicDynamicArray& result,
+                      size_t begin, size_t end) const {
+        size_t overlap = (size < other.size) ? size : other.size;
+        size_t overlapEnd = (end < overlap) ? end : overlap;
+        if (begin < overlapEnd) {
+            selectCombineKernel<Domain, Subtract>()(data + begin, other.data + begin,
+                                                    result.data + begin, overlapEnd - begin);
+        }
+        size_t tailBegin = (begin > overlap) ? begin : overlap;
+        size_t selfEnd = (end < size) ? end : size;
+        for (size_t i = tailBegin; i < selfEnd; ++i) {
+            result.data[i] = data[i];
+        }
+        size_t otherEnd = (end < other.size) ? end : other.size;
+        for (size_t i = tailBegin; i < otherEnd; ++i) {
+            result.data[i] = Subtract ? Domain::template combine<true>(0, other.data[i]) : other.data[i];
+        }
+    }
+};
+
+// DynamicArray keeps the original 4-byte layout; the others use the
+// narrowest storage for their domain
+using DynamicArray = BasicDynamicArray<ValueDomain<-100, 100, OverflowPolicy::Saturate, int> >;
+using CompactDynamicArray = BasicDynamicArray<ValueDomain<-100, 100> >;
+using ByteDynamicArray = BasicDynamicArray<ValueDomain<0, 255> >;
+using ShortDynamicArray = BasicDynamicArray<ValueDomain<-32768, 32767> >;
+
+// Summary returned by computeStatistics()
+struct ArrayStatistics {
+    int min;
+    int max;
+    long long sum;
+    double mean;
+    double variance;
+    size_t count;
 };
 
-class ExtendedDynamicArray : public DynamicArray {
+// Keeps a counting histogram over the possible values next to the data, so
+// order statistics are answered in O(domain size) without touching the
+// elements. Domains are limited to 256 values to keep the histogram small.
+// Modifications must go through this class (setValue/pushBack below), not
+// through a BasicDynamicArray reference, or the histogram goes stale.
+template <typename Domain>
+class BasicExtendedDynamicArray : public BasicDynamicArray<Domain> {
+    using Base = BasicDynamicArray<Domain>;
+    using Base::data;
+    using Base::size;
+
+    static const int histogramBins = Domain::maxValue - Domain::minValue + 1;
+    static_assert(histogramBins <= 256, "The histogram supports domains of at most 256 values");
+    size_t counts[histogramBins];
+
 public:
     // Constructors
-    ExtendedDynamicArray(size_t arraySize) : DynamicArray(arraySize) {}
-    ExtendedDynamicArray(const DynamicArray& other) : DynamicArray(other) {}
+    // A fresh array is all zeros, so the histogram is known without
+    // reading (and committing) a single page
+    BasicExtendedDynamicArray(size_t arraySize, PageBacking backing = PageBacking::Normal)
+        : Base(arraySize, backing) {
+        std::fill(counts, counts + histogramBins, 0);
+        counts[0 - Domain::minValue] = size;
+    }
+
+    BasicExtendedDynamicArray(const Base& other) : Base(other) {
+        rebuildHistogram();
+    }
+
+    BasicExtendedDynamicArray(Base&& other) noexcept : Base(std::move(other)) {
+        rebuildHistogram();
+    }
+
+    template <typename Left, typename Right, bool Subtract>
+    BasicExtendedDynamicArray(const SaturatingExpression<Left, Right, Subtract>& expression)
+        : Base(expression) {
+        rebuildHistogram();
+    }
+
+    // Build the histogram on the pool; the statistics themselves are O(201)
+    BasicExtendedDynamicArray(const Base& other, const ParallelPolicy& policy) : Base(other) {
+        rebuildHistogram(policy);
+    }
+
+    BasicExtendedDynamicArray(Base&& other, const ParallelPolicy& policy) : Base(std::move(other)) {
+        rebuildHistogram(policy);
+    }
+
+    BasicExtendedDynamicArray(const BasicExtendedDynamicArray& other) = default;
+
+    BasicExtendedDynamicArray(BasicExtendedDynamicArray&& other) noexcept : Base(std::move(other)) {
+        std::copy(other.counts, other.counts + histogramBins, counts);
+        std::fill(other.counts, other.counts + histogramBins, 0);
+    }
+
+    BasicExtendedDynamicArray& operator=(const BasicExtendedDynamicArray& other) = default;
+
+    BasicExtendedDynamicArray& operator=(BasicExtendedDynamicArray&& other) noexcept {
+        if (this != &other) {
+            Base::operator=(std::move(other));
+            std::copy(other.counts, other.counts + histogramBins, counts);
+            std::fill(other.counts, other.counts + histogramBins, 0);
+        }
+        return *this;
+    }
+
+    void swap(BasicExtendedDynamicArray& other) noexcept {
+        Base::swap(other);
+        std::swap(counts, other.counts);
+    }
+
+    friend void swap(BasicExtendedDynamicArray& a, BasicExtendedDynamicArray& b) noexcept {
+        a.swap(b);
+    }
+
+    void setValue(size_t index, int value) {
+        int oldValue = this->getValue(index);
+        Base::setValue(index, value);
+        --counts[oldValue - Domain::minValue];
+        ++counts[value - Domain::minValue];
+    }
+
+    void pushBack(int value) {
+        Base::pushBack(value);
+        ++counts[value - Domain::minValue];
+    }
+
+    void appendRange(const int* values, size_t count) {
+        Base::appendRange(values, count);
+        for (size_t i = 0; i < count; ++i) {
+            ++counts[values[i] - Domain::minValue];
+        }
+    }
+
+    void assign(const int* first, const int* last) {
+        Base::assign(first, last);
+        rebuildHistogram();
+    }
+
+    void fill(int value) {
+        Base::fill(value);
+        std::fill(counts, counts + histogramBins, 0);
+        counts[value - Domain::minValue] = size;
+    }
 
     // Calculate average value
     double calculateAverage() const {
-        size_t currentSize = getSize();
-        if (currentSize == 0) {
+        if (size == 0) {
             throw std::runtime_error("Cannot calculate average for empty array");
         }
         
-        double sum = 0.0;
-        for (size_t i = 0; i < currentSize; ++i) {
-            sum += getValue(i);
+        long long sum = 0;
+        for (int bin = 0; bin < histogramBins; ++bin) {
+            sum += static_cast<long long>(counts[bin]) * (bin + Domain::minValue);
         }
         
-        return sum / currentSize;
+        return static_cast<double>(sum) / size;
     }
 
     // Calculate median value
-    double calculateMedian() {
-        size_t currentSize = getSize();
-        if (currentSize == 0) {
+    double calculateMedian() const {
+        if (size == 0) {
             throw std::runtime_error("Cannot calculate median for empty array");
         }
         
-        // Create temporary array for sorting
-        int* tempArray = new int[currentSize];
-        for (size_t i = 0; i < currentSize; ++i) {
-            tempArray[i] = getValue(i);
+        return percentile(50.0);
+    }
+
+    // Percentile p in [0, 100], linear interpolation between closest ranks
+    double percentile(double p) const {
+        if (size == 0) {
+            throw std::runtime_error("Cannot calculate percentile for empty array");
         }
-        
-        // Sort array
-        std::sort(tempArray, tempArray + currentSize);
-        
-        double median;
-        if (currentSize % 2 == 0) {
-            // For even number of elements - average of two central elements
-            median = (tempArray[currentSize / 2 - 1] + tempArray[currentSize / 2]) / 2.0;
-        } else {
-            // For odd number of elements - central element
-            median = tempArray[currentSize / 2];
+        if (!(p >= 0.0 && p <= 100.0)) {
+            throw std::invalid_argument("Percentile must be in range from 0 to 100");
         }
         
-        delete[] tempArray;
-        return median;
+        double rank = p / 100.0 * (size - 1);
+        size_t lower = static_cast<size_t>(rank);
+        size_t upper = (lower + 1 < size) ? lower + 1 : lower;
+        double fraction = rank - lower;
+        
+        int lowerValue = nthSmallest(lower);
+        int upperValue = (fraction > 0.0) ? nthSmallest(upper) : lowerValue;
+        return lowerValue + (upperValue - lowerValue) * fraction;
     }
 
     // Find minimum element
     int findMin() const {
-        size_t currentSize = getSize();
-        if (currentSize == 0) {
+        if (size == 0) {
             throw std::runtime_error("Cannot find minimum element in empty array");
         }
         
-        int minValue = getValue(0);
-        for (size_t i = 1; i < currentSize; ++i) {
-            if (getValue(i) < minValue) {
-                minValue = getValue(i);
-            }
+        int bin = 0;
+        while (counts[bin] == 0) {
+            ++bin;
         }
         
-        return minValue;
+        return bin + Domain::minValue;
     }
 
     // Find maximum element
     int findMax() const {
-        size_t currentSize = getSize();
-        if (currentSize == 0) {
+        if (size == 0) {
             throw std::runtime_error("Cannot find maximum element in empty array");
         }
         
-        int maxValue = getValue(0);
-        for (size_t i = 1; i < currentSize; ++i) {
-            if (getValue(i) > maxValue) {
-                maxValue = getValue(i);
+        int bin = histogramBins - 1;
+        while (counts[bin] == 0) {
+            --bin;
+        }
+        
+        return bin + Domain::minValue;
+    }
+
+    // Find the most frequent element (the smallest one on ties)
+    int findMode() const {
+        if (size == 0) {
+            throw std::runtime_error("Cannot find mode of empty array");
+        }
+        
+        int modeBin = 0;
+        for (int bin = 1; bin < histogramBins; ++bin) {
+            if (counts[bin] > counts[modeBin]) {
+                modeBin = bin;
+            }
+        }
+        
+        return modeBin + Domain::minValue;
+    }
+
+    // Min, max, sum, mean and population variance in one pass over the histogram
+    ArrayStatistics computeStatistics() const {
+        if (size == 0) {
+            throw std::runtime_error("Cannot calculate statistics for empty array");
+        }
+        
+        ArrayStatistics stats;
+        stats.min = Domain::maxValue;
+        stats.max = Domain::minValue;
+        stats.sum = 0;
+        stats.count = size;
+        long long sumOfSquares = 0;
+        for (int bin = 0; bin < histogramBins; ++bin) {
+            if (counts[bin] == 0) {
+                continue;
             }
+            int value = bin + Domain::minValue;
+            long long count = static_cast<long long>(counts[bin]);
+            stats.min = (value < stats.min) ? value : stats.min;
+            stats.max = (value > stats.max) ? value : stats.max;
+            stats.sum += count * value;
+            sumOfSquares += count * value * value;
         }
         
-        return maxValue;
+        stats.mean = static_cast<double>(stats.sum) / size;
+        stats.variance = static_cast<double>(sumOfSquares) / size - stats.mean * stats.mean;
+        if (stats.variance < 0.0) {
+            stats.variance = 0.0;
+        }
+        return stats;
     }
 
     // Method to print all statistical data
-    void printStatistics() {
+    void printStatistics() const {
         std::cout << "Array statistics:" << std::endl;
-        print();
-        std::cout << "Minimum element: " << findMin() << std::endl;
-        std::cout << "Maximum element: " << findMax() << std::endl;
-        std::cout << "Average value: " << calculateAverage() << std::endl;
+        this->print();
+        ArrayStatistics stats = computeStatistics();
+        std::cout << "Minimum element: " << stats.min << std::endl;
+        std::cout << "Maximum element: " << stats.max << std::endl;
+        std::cout << "Average value: " << stats.mean << std::endl;
         std::cout << "Median value: " << calculateMedian() << std::endl;
     }
+
+private:
+    void rebuildHistogram() {
+        std::fill(counts, counts + histogramBins, 0);
+        for (size_t i = 0; i < size; ++i) {
+            ++counts[data[i] - Domain::minValue];
+        }
+    }
+
+    // Every chunk counts into a local histogram and merges it under a lock
+    void rebuildHistogram(const ParallelPolicy& policy) {
+        std::fill(counts, counts + histogramBins, 0);
+        std::mutex mergeMutex;
+        policy.run(size, [&](size_t begin, size_t end) {
+            size_t local[histogramBins] = {};
+            for (size_t i = begin; i < end; ++i) {
+                ++local[data[i] - Domain::minValue];
+            }
+            std::lock_guard<std::mutex> lock(mergeMutex);
+            for (int bin = 0; bin < histogramBins; ++bin) {
+                counts[bin] += local[bin];
+            }
+        });
+    }
+
+    // k-th smallest element (0-based), found by walking the cumulative counts
+    int nthSmallest(size_t k) const {
+        size_t seen = 0;
+        int bin = 0;
+        while (seen + counts[bin] <= k) {
+            seen += counts[bin];
+            ++bin;
+        }
+        return bin + Domain::minValue;
+    }
+};
+
+using ExtendedDynamicArray = BasicExtendedDynamicArray<DynamicArray::DomainType>;
+using CompactExtendedDynamicArray = BasicExtendedDynamicArray<CompactDynamicArray::DomainType>;
+using ByteExtendedDynamicArray = BasicExtendedDynamicArray<ByteDynamicArray::DomainType>;
+
+// Array shared by several threads without a global lock.
+// - setValue is wait-free: one relaxed store into an atomic cell plus two
+//   increments of a per-thread shard counter. It never allocates.
+// - pushBack is lock-free: the elements live in segments of doubling size
+//   (firstSegmentSize, 2x, 4x, ...) that are installed with a CAS and never
+//   move. The segment for the next index is installed before the index is
+//   claimed with a CAS on reserved, so every claimed slot already has its
+//   segment and a failed pushBack (full array, bad_alloc) claims nothing.
+// - snapshot() copies a state that existed at one moment: it waits until
+//   no update is in flight, copies, and retries if any update started in
+//   the meantime. As in a seqlock, writers put a release fence between the
+//   start counter and the cell store and the reader an acquire fence
+//   between the copy and the re-check. Under a constant stream of writes it may retry for a
+//   while, but never blocks writers.
+// add/subtract and the statistics work on such snapshots.
+template <typename Domain>
+class BasicConcurrentDynamicArray {
+    typedef typename Domain::StorageType Element;
+    typedef std::atomic<Element> Cell;
+
+    static_assert(sizeof(Element) == 1, "Concurrent arrays use 8-bit atomic cells");
+
+public:
+    typedef Domain DomainType;
+
+    BasicConcurrentDynamicArray() : reserved(0) {
+        for (size_t i = 0; i < maxSegments; ++i) {
+            segments[i].store(nullptr, std::memory_order_relaxed);
+        }
+        for (size_t i = 0; i < shardCount; ++i) {
+            shards[i].started.store(0, std::memory_order_relaxed);
+            shards[i].finished.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    BasicConcurrentDynamicArray(const BasicConcurrentDynamicArray&) = delete;
+    BasicConcurrentDynamicArray& operator=(const BasicConcurrentDynamicArray&) = delete;
+
+    ~BasicConcurrentDynamicArray() {
+        for (size_t i = 0; i < maxSegments; ++i) {
+            delete[] segments[i].load(std::memory_order_relaxed);
+        }
+    }
+
+    // Number of claimed slots. A slot whose pushBack is still in progress
+    // reads as zero until the value is stored.
+    size_t getSize() const {
+        return reserved.load(std::memory_order_acquire);
+    }
+
+    void setValue(size_t index, int value) {
+        if (index >= getSize()) {
+            throw std::out_of_range("Index is out of array bounds");
+        }
+        if (!Domain::contains(value)) {
+            throw std::invalid_argument("Value must be in range " + Domain::rangeText());
+        }
+        size_t segment = segmentOf(index);
+        Cell* cells = segments[segment].load(std::memory_order_acquire);
+        Shard& shard = localShard();
+        shard.started.fetch_add(1);
+        // Pairs with the acquire fence in snapshot(): a reader that copied
+        // this store is guaranteed to see the started increment
+        std::atomic_thread_fence(std::memory_order_release);
+        cells[index - segmentStart(segment)].store(static_cast<Element>(value), std::memory_order_relaxed);
+        shard.finished.fetch_add(1);
+    }
+
+    int getValue(size_t index) const {
+        if (index >= getSize()) {
+            throw std::out_of_range("Index is out of array bounds");
+        }
+        size_t segment = segmentOf(index);
+        const Cell* cells = segments[segment].load(std::memory_order_acquire);
+        return cells[index - segmentStart(segment)].load(std::memory_order_relaxed);
+    }
+
+    void pushBack(int value) {
+        if (!Domain::contains(value)) {
+            throw std::invalid_argument("Value must be in range " + Domain::rangeText());
+        }
+        Shard& shard = localShard();
+        shard.started.fetch_add(1);
+        std::atomic_thread_fence(std::memory_order_release);
+        size_t index = reserved.load();
+        size_t segment;
+        Cell* cells;
+        try {
+            do {
+                segment = segmentOf(index);
+                if (segment >= maxSegments) {
+                    throw std::length_error("Concurrent array is full");
+                }
+                cells = installSegment(segment);
+            } while (!reserved.compare_exchange_weak(index, index + 1));
+        } catch (...) {
+            shard.finished.fetch_add(1);
+            throw;
+        }
+        cells[index - segmentStart(segment)].store(static_cast<Element>(value), std::memory_order_relaxed);
+        shard.finished.fetch_add(1);
+    }
+
+    BasicDynamicArray<Domain> snapshot() const {
+        uint64_t started[shardCount];
+        while (true) {
+            if (!quiescent(started)) {
+                std::this_thread::yield();
+                continue;
+            }
+            size_t count = reserved.load();
+            BasicDynamicArray<Domain> result(count, Uninitialized());
+            for (size_t segment = 0; segmentStart(segment) < count; ++segment) {
+                const Cell* cells = segments[segment].load(std::memory_order_acquire);
+                size_t begin = segmentStart(segment);
+                size_t end = (begin + segmentSize(segment) < count) ? begin + segmentSize(segment) : count;
+                for (size_t i = begin; i < end; ++i) {
+                    result.data[i] = cells[i - begin].load(std::memory_order_relaxed);
+                }
+            }
+            // A relaxed cell store does not synchronize by itself; with the
+            // writers' release fences this makes any update whose value was
+            // copied above visible to the re-check below
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (unchangedSince(started)) {
+                return result;
+            }
+        }
+    }
+
+    BasicDynamicArray<Domain> add(const BasicConcurrentDynamicArray& other) const {
+        return snapshot().add(other.snapshot());
+    }
+
+    BasicDynamicArray<Domain> subtract(const BasicConcurrentDynamicArray& other) const {
+        return snapshot().subtract(other.snapshot());
+    }
+
+    ArrayStatistics computeStatistics() const {
+        return BasicExtendedDynamicArray<Domain>(snapshot()).computeStatistics();
+    }
+
+private:
+    static const size_t firstSegmentSize = 1024;
+    static const size_t maxSegments = 40;
+    static const size_t shardCount = 64;
+
+    // One cache line per shard so threads do not contend on the counters
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> started;
+        std::atomic<uint64_t> finished;
+    };
+
+    static size_t segmentOf(size_t index) {
+        size_t blocks = index / firstSegmentSize + 1;
+#if defined(__GNUC__)
+        return 63 - __builtin_clzll(blocks);
+#else
+        size_t segment = 0;
+        while (blocks >>= 1) {
+            ++segment;
+        }
+        return segment;
+#endif
+    }
+
+    static size_t segmentStart(size_t segment) {
+        return firstSegmentSize * ((static_cast<size_t>(1) << segment) - 1);
+    }
+
+    static size_t segmentSize(size_t segment) {
+        return firstSegmentSize << segment;
+    }
+
+    // The losing thread of a concurrent install frees its copy
+    Cell* installSegment(size_t segment) {
+        Cell* cells = segments[segment].load(std::memory_order_acquire);
+        if (cells != nullptr) {
+            return cells;
+        }
+        Cell* fresh = new Cell[segmentSize(segment)]();
+        if (segments[segment].compare_exchange_strong(cells, fresh, std::memory_order_acq_rel)) {
+            return fresh;
+        }
+        delete[] fresh;
+        return cells;
+    }
+
+    Shard& localShard() {
+        static std::atomic<size_t> nextShard(0);
+        thread_local size_t shard = nextShard.fetch_add(1, std::memory_order_relaxed) % shardCount;
+        return shards[shard];
+    }
+
+    // True when no update is in flight; remembers the start counters
+    bool quiescent(uint64_t* started) const {
+        for (size_t i = 0; i < shardCount; ++i) {
+            uint64_t finished = shards[i].finished.load();
+            started[i] = shards[i].started.load();
+            if (started[i] != finished) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool unchangedSince(const uint64_t* started) const {
+        for (size_t i = 0; i < shardCount; ++i) {
+            if (shards[i].started.load() != started[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::atomic<Cell*> segments[maxSegments];
+    std::atomic<size_t> reserved;
+    Shard shards[shardCount];
 };
 
+using ConcurrentDynamicArray = BasicConcurrentDynamicArray<CompactDynamicArray::DomainType>;
+
 int main() {
     try {
         int size1, size2;
         
         std::cout << "Enter size of first array: ";
         std::cin >> size1;
-        ExtendedDynamicArray arr1(size1);
+        ExtendedDynamicArray arr1(0);
         
         std::cout << "Enter " << size1 << " elements of first array (from -100 to 100):" << std::endl;
+        // Each value is checked as soon as it is read; the whole input is then
+        // copied in with one assign, with no zero-fill beforehand
+        std::vector<int> values1;
+        values1.reserve(size1);
         for (int i = 0; i < size1; ++i) {
             int value;
             std::cin >> value;
-            arr1.setValue(i, value);
+            if (!ExtendedDynamicArray::DomainType::contains(value)) {
+                throw std::invalid_argument("Value must be in range " + ExtendedDynamicArray::DomainType::rangeText());
+            }
+            values1.push_back(value);
         }
+        arr1.assign(values1.data(), values1.data() + values1.size());
         
         std::cout << "Enter size of second array: ";
         std::cin >> size2;
-        ExtendedDynamicArray arr2(size2);
+        ExtendedDynamicArray arr2(0);
         
         std::cout << "Enter " << size2 << " elements of second array (from -100 to 100):" << std::endl;
+        std::vector<int> values2;
+        values2.reserve(size2);
         for (int i = 0; i < size2; ++i) {
             int value;
             std::cin >> value;
-            arr2.setValue(i, value);
+            if (!ExtendedDynamicArray::DomainType::contains(value)) {
+                throw std::invalid_argument("Value must be in range " + ExtendedDynamicArray::DomainType::rangeText());
+            }
+            values2.push_back(value);
         }
+        arr2.assign(values2.data(), values2.data() + values2.size());
         
         std::cout << "\nFirst array: ";
         arr1.print();
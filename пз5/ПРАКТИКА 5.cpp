@@ -1,249 +1,2450 @@
 #include <iostream>
+#include <algorithm>
 #include <stdexcept>
+#include <utility>
 #include <fstream>
+#include <charconv>
 #include <chrono>
 #include <iomanip>
 #include <sstream>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <string>
+#include <thread>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <atomic>
+#include <cstdio>
+#include <ctime>
+#include <mutex>
+#include <vector>
+
+#if defined(__has_include)
+#if __has_include(<span>)
+#include <span>
+#endif
+#endif
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define DYNAMIC_ARRAY_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define DYNAMIC_ARRAY_TARGET(isa)
+#else
+#define DYNAMIC_ARRAY_TARGET(isa) __attribute__((target(isa)))
+#endif
+#endif
+
+// Поэлементные ядра сложения/вычитания с насыщением до [-100, 100].
+// Реализация выбирается один раз по возможностям процессора.
+typedef void (*SaturatingKernel)(const int* a, const int* b, int* out, size_t count);
+
+template <bool Subtract>
+void saturateScalar(const int* a, const int* b, int* out, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        int value = Subtract ? a[i] - b[i] : a[i] + b[i];
+        value = (value < -100) ? -100 : value;
+        value = (value > 100) ? 100 : value;
+        out[i] = value;
+    }
+}
+
+#ifdef DYNAMIC_ARRAY_X86
+template <bool Subtract>
+DYNAMIC_ARRAY_TARGET("sse2")
+void saturateSSE2(const int* a, const int* b, int* out, size_t count) {
+    const __m128i low = _mm_set1_epi32(-100);
+    const __m128i high = _mm_set1_epi32(100);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        __m128i value = Subtract ? _mm_sub_epi32(x, y) : _mm_add_epi32(x, y);
+        __m128i mask = _mm_cmpgt_epi32(value, high);
+        value = _mm_or_si128(_mm_and_si128(mask, high), _mm_andnot_si128(mask, value));
+        mask = _mm_cmplt_epi32(value, low);
+        value = _mm_or_si128(_mm_and_si128(mask, low), _mm_andnot_si128(mask, value));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), value);
+    }
+    saturateScalar<Subtract>(a + i, b + i, out + i, count - i);
+}
+
+template <bool Subtract>
+DYNAMIC_ARRAY_TARGET("avx2")
+void saturateAVX2(const int* a, const int* b, int* out, size_t count) {
+    const __m256i low = _mm256_set1_epi32(-100);
+    const __m256i high = _mm256_set1_epi32(100);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        __m256i value = Subtract ? _mm256_sub_epi32(x, y) : _mm256_add_epi32(x, y);
+        value = _mm256_min_epi32(_mm256_max_epi32(value, low), high);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), value);
+    }
+    saturateScalar<Subtract>(a + i, b + i, out + i, count - i);
+}
+
+template <bool Subtract>
+DYNAMIC_ARRAY_TARGET("avx512f")
+void saturateAVX512(const int* a, const int* b, int* out, size_t count) {
+    const __m512i low = _mm512_set1_epi32(-100);
+    const __m512i high = _mm512_set1_epi32(100);
+    const __mmask16 allLanes = 0xFFFF;
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m512i x = _mm512_loadu_si512(a + i);
+        __m512i y = _mm512_loadu_si512(b + i);
+        __m512i value = Subtract ? _mm512_sub_epi32(x, y) : _mm512_add_epi32(x, y);
+        // maskz-варианты с полной маской дают те же vpmaxsd/vpminsd, но без
+        // ложного -Wmaybe-uninitialized из _mm512_undefined_epi32 в GCC
+        value = _mm512_maskz_min_epi32(allLanes, _mm512_maskz_max_epi32(allLanes, value, low), high);
+        _mm512_storeu_si512(out + i, value);
+    }
+    saturateScalar<Subtract>(a + i, b + i, out + i, count - i);
+}
+#endif
+
+enum class SimdLevel { Scalar, SSE2, AVX2, AVX512 };
+
+inline SimdLevel detectSimdLevel() {
+#if !defined(DYNAMIC_ARRAY_X86)
+    return SimdLevel::Scalar;
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    int maxLeaf = info[0];
+    __cpuid(info, 1);
+    bool sse2 = (info[3] & (1 << 26)) != 0;
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    if (osxsave && avx && maxLeaf >= 7) {
+        unsigned long long xcr0 = _xgetbv(0);
+        __cpuidex(info, 7, 0);
+        if ((xcr0 & 0xE6) == 0xE6 && (info[1] & (1 << 16)) != 0) {
+            return SimdLevel::AVX512;
+        }
+        if ((xcr0 & 0x6) == 0x6 && (info[1] & (1 << 5)) != 0) {
+            return SimdLevel::AVX2;
+        }
+    }
+    return sse2 ? SimdLevel::SSE2 : SimdLevel::Scalar;
+#else
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return SimdLevel::AVX512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return SimdLevel::AVX2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return SimdLevel::SSE2;
+    }
+    return SimdLevel::Scalar;
+#endif
+}
+
+template <bool Subtract>
+SaturatingKernel selectSaturatingKernel() {
+    static const SimdLevel level = detectSimdLevel();
+    switch (level) {
+#ifdef DYNAMIC_ARRAY_X86
+        case SimdLevel::AVX512:
+            return saturateAVX512<Subtract>;
+        case SimdLevel::AVX2:
+            return saturateAVX2<Subtract>;
+        case SimdLevel::SSE2:
+            return saturateSSE2<Subtract>;
+#endif
+        default:
+            return saturateScalar<Subtract>;
+    }
+}
+
+// Индекс первого значения вне [-100, 100] или count, если все в диапазоне.
+// Векторные версии считают минимум и максимум блока и ищут нарушителя
+// поэлементно только в том блоке, где он есть.
+typedef size_t (*RangeCheckKernel)(const int* values, size_t count);
+
+static const size_t rangeCheckBlock = 1024;
+
+size_t findOutOfRangeScalar(const int* values, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        if (values[i] < -100 || values[i] > 100) {
+            return i;
+        }
+    }
+    return count;
+}
+
+#ifdef DYNAMIC_ARRAY_X86
+DYNAMIC_ARRAY_TARGET("sse2")
+size_t findOutOfRangeSSE2(const int* values, size_t count) {
+    const __m128i low = _mm_set1_epi32(-100);
+    const __m128i high = _mm_set1_epi32(100);
+    size_t begin = 0;
+    for (; begin + rangeCheckBlock <= count; begin += rangeCheckBlock) {
+        __m128i bad = _mm_setzero_si128();
+        for (size_t i = begin; i < begin + rangeCheckBlock; i += 4) {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+            bad = _mm_or_si128(bad, _mm_or_si128(_mm_cmplt_epi32(x, low), _mm_cmpgt_epi32(x, high)));
+        }
+        if (_mm_movemask_epi8(bad) != 0) {
+            return begin + findOutOfRangeScalar(values + begin, rangeCheckBlock);
+        }
+    }
+    return begin + findOutOfRangeScalar(values + begin, count - begin);
+}
+
+DYNAMIC_ARRAY_TARGET("avx2")
+size_t findOutOfRangeAVX2(const int* values, size_t count) {
+    const __m256i low = _mm256_set1_epi32(-100);
+    const __m256i high = _mm256_set1_epi32(100);
+    size_t begin = 0;
+    for (; begin + rangeCheckBlock <= count; begin += rangeCheckBlock) {
+        __m256i minimum = _mm256_setzero_si256();
+        __m256i maximum = _mm256_setzero_si256();
+        for (size_t i = begin; i < begin + rangeCheckBlock; i += 8) {
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+            minimum = _mm256_min_epi32(minimum, x);
+            maximum = _mm256_max_epi32(maximum, x);
+        }
+        __m256i bad = _mm256_or_si256(_mm256_cmpgt_epi32(low, minimum), _mm256_cmpgt_epi32(maximum, high));
+        if (!_mm256_testz_si256(bad, bad)) {
+            return begin + findOutOfRangeScalar(values + begin, rangeCheckBlock);
+        }
+    }
+    return begin + findOutOfRangeScalar(values + begin, count - begin);
+}
+
+DYNAMIC_ARRAY_TARGET("avx512f")
+size_t findOutOfRangeAVX512(const int* values, size_t count) {
+    const __m512i low = _mm512_set1_epi32(-100);
+    const __m512i high = _mm512_set1_epi32(100);
+    size_t begin = 0;
+    for (; begin + rangeCheckBlock <= count; begin += rangeCheckBlock) {
+        // Маски сравнений копятся напрямую: min/max-редукция через
+        // _mm512_min_epi32 дает в GCC ложное -Wmaybe-uninitialized
+        __mmask16 outside = 0;
+        for (size_t i = begin; i < begin + rangeCheckBlock; i += 16) {
+            __m512i x = _mm512_loadu_si512(values + i);
+            outside |= _mm512_cmplt_epi32_mask(x, low) | _mm512_cmpgt_epi32_mask(x, high);
+        }
+        if (outside != 0) {
+            return begin + findOutOfRangeScalar(values + begin, rangeCheckBlock);
+        }
+    }
+    return begin + findOutOfRangeScalar(values + begin, count - begin);
+}
+#endif
+
+inline RangeCheckKernel selectRangeCheckKernel() {
+    static const SimdLevel level = detectSimdLevel();
+    switch (level) {
+#ifdef DYNAMIC_ARRAY_X86
+        case SimdLevel::AVX512:
+            return findOutOfRangeAVX512;
+        case SimdLevel::AVX2:
+            return findOutOfRangeAVX2;
+        case SimdLevel::SSE2:
+            return findOutOfRangeSSE2;
+#endif
+        default:
+            return findOutOfRangeScalar;
+    }
+}
+
+// Очередь фоновой записи: отдельный поток ввода-вывода забирает все
+// накопившиеся задания за один захват блокировки и выполняет их подряд.
+// Если невыполненных заданий maxPending или больше, submit ждет, чтобы
+// снимки массивов не копились в памяти быстрее, чем пишется диск.
+class AsyncSaveQueue {
+public:
+    static AsyncSaveQueue& instance() {
+        static AsyncSaveQueue queue;
+        return queue;
+    }
+
+    std::future<void> submit(std::function<void()> job) {
+        std::packaged_task<void()> task(std::move(job));
+        std::future<void> result = task.get_future();
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            spaceAvailable.wait(lock, [this] { return pending < maxPending; });
+            ++pending;
+            jobs.push_back(std::move(task));
+        }
+        jobAvailable.notify_one();
+        return result;
+    }
+
+    void setMaxPending(size_t limit) {
+        std::lock_guard<std::mutex> lock(mutex);
+        maxPending = (limit > 0) ? limit : 1;
+        spaceAvailable.notify_all();
+    }
+
+    ~AsyncSaveQueue() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        jobAvailable.notify_one();
+        worker.join();
+    }
+
+private:
+    AsyncSaveQueue() : maxPending(8), pending(0), stopping(false) {
+        worker = std::thread([this] { run(); });
+    }
+
+    void run() {
+        for (;;) {
+            std::deque<std::packaged_task<void()>> batch;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                jobAvailable.wait(lock, [this] { return stopping || !jobs.empty(); });
+                if (jobs.empty()) {
+                    return;
+                }
+                batch.swap(jobs);
+            }
+
+            for (size_t i = 0; i < batch.size(); ++i) {
+                batch[i]();
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                pending -= batch.size();
+            }
+            spaceAvailable.notify_all();
+        }
+    }
+
+    std::deque<std::packaged_task<void()>> jobs;
+    std::mutex mutex;
+    std::condition_variable jobAvailable;
+    std::condition_variable spaceAvailable;
+    size_t maxPending;
+    size_t pending;
+    bool stopping;
+    std::thread worker;
+};
+
+// Пул блоков по классам размеров: степени двойки от 64 байт до 64 КиБ.
+// Освобожденный блок возвращается в список своего класса и сразу отдается
+// следующему запросу того же класса; память берется у upstream кусками по
+// blocksPerChunk блоков и возвращается только в release() или деструкторе.
+// Запросы больше maxBlock идут прямо в upstream. Не потокобезопасен.
+// Для памяти одного запроса подходит std::pmr::monotonic_buffer_resource:
+// выделение - сдвиг указателя, освобождение всего сразу через release().
+class SizeClassPool : public std::pmr::memory_resource {
+public:
+    explicit SizeClassPool(std::pmr::memory_resource* upstreamResource = std::pmr::get_default_resource())
+        : upstream(upstreamResource), chunks(nullptr) {
+        for (size_t i = 0; i < classCount; ++i) {
+            freeLists[i] = nullptr;
+        }
+    }
+
+    SizeClassPool(const SizeClassPool&) = delete;
+    SizeClassPool& operator=(const SizeClassPool&) = delete;
+
+    ~SizeClassPool() {
+        release();
+    }
+
+    // Возвращает upstream всю память пула, в том числе еще выданные блоки
+    void release() {
+        while (chunks != nullptr) {
+            Chunk* next = chunks->next;
+            upstream->deallocate(chunks, chunks->bytes, alignof(std::max_align_t));
+            chunks = next;
+        }
+        for (size_t i = 0; i < classCount; ++i) {
+            freeLists[i] = nullptr;
+        }
+    }
+
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    struct Chunk {
+        Chunk* next;
+        size_t bytes;
+    };
+
+    static const size_t minBlock = 64;
+    static const size_t classCount = 11;
+    static const size_t maxBlock = minBlock << (classCount - 1);
+    static const size_t blocksPerChunk = 16;
+    static const size_t chunkHeader =
+        (sizeof(Chunk) + alignof(std::max_align_t) - 1) / alignof(std::max_align_t) * alignof(std::max_align_t);
+
+    static size_t sizeClass(size_t bytes) {
+        size_t block = minBlock;
+        size_t index = 0;
+        while (block < bytes) {
+            block <<= 1;
+            ++index;
+        }
+        return index;
+    }
+
+    static bool isPooled(size_t bytes, size_t alignment) {
+        return bytes <= maxBlock && alignment <= alignof(std::max_align_t);
+    }
+
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        if (!isPooled(bytes, alignment)) {
+            return upstream->allocate(bytes, alignment);
+        }
+        size_t index = sizeClass(bytes);
+        if (freeLists[index] == nullptr) {
+            refill(index);
+        }
+        FreeBlock* block = freeLists[index];
+        freeLists[index] = block->next;
+        return block;
+    }
+
+    void do_deallocate(void* pointer, size_t bytes, size_t alignment) override {
+        if (!isPooled(bytes, alignment)) {
+            upstream->deallocate(pointer, bytes, alignment);
+            return;
+        }
+        size_t index = sizeClass(bytes);
+        FreeBlock* block = static_cast<FreeBlock*>(pointer);
+        block->next = freeLists[index];
+        freeLists[index] = block;
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    void refill(size_t index) {
+        size_t blockSize = minBlock << index;
+        size_t bytes = chunkHeader + blockSize * blocksPerChunk;
+        char* raw = static_cast<char*>(upstream->allocate(bytes, alignof(std::max_align_t)));
+        Chunk* chunk = reinterpret_cast<Chunk*>(raw);
+        chunk->next = chunks;
+        chunk->bytes = bytes;
+        chunks = chunk;
+        for (size_t i = blocksPerChunk; i-- > 0;) {
+            FreeBlock* block = reinterpret_cast<FreeBlock*>(raw + chunkHeader + i * blockSize);
+            block->next = freeLists[index];
+            freeLists[index] = block;
+        }
+    }
+
+    std::pmr::memory_resource* upstream;
+    Chunk* chunks;
+    FreeBlock* freeLists[classCount];
+};
+
+// Тег конструктора без заполнения нулями: вызывающий код сам записывает
+// все элементы (как результат add/subtract)
+struct Uninitialized {};
+
+// Буферы от этого размера берутся у ОС через mmap: новые анонимные страницы
+// уже заполнены нулями и выделяются только при первой записи, поэтому
+// большой нулевой массив ничего не стоит, пока в него не пишут.
+const size_t lazyZeroThreshold = size_t(1) << 20;
+
+// Анонимное отображение из нулей. nullptr, если отображение недоступно;
+// тогда вызывающий код берет память из кучи.
+inline void* mapZeroedPages(size_t bytes) {
+#ifdef _WIN32
+    (void)bytes;
+    return nullptr;
+#else
+    void* block = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return (block == MAP_FAILED) ? nullptr : block;
+#endif
+}
+
+inline void unmapPages(void* block, size_t bytes) {
+#ifdef _WIN32
+    (void)block;
+    (void)bytes;
+#else
+    munmap(block, bytes);
+#endif
+}
 
 class DynamicArray {
 protected:
     int* data;
     size_t size;
+    size_t allocated;
+    std::pmr::memory_resource* memory;
+
+    // Разреженный вид: data == nullptr, ненулевые элементы хранятся парами
+    // (индекс, значение) по возрастанию индекса. Векторы берут память из
+    // обычной кучи независимо от resource.
+    bool sparse;
+    std::vector<size_t> sparseIndices;
+    std::vector<int> sparseValues;
+
+    // Плотная копия разреженного массива для константных getData/begin/end/
+    // view. Строится при первом обращении и публикуется атомарно, поэтому
+    // одновременные читатели не гоняются; сбрасывается любой записью.
+    // Память из кучи, как и у векторов пар.
+    mutable std::atomic<int*> denseView;
+
+    // Массивы короче sparseMinSize всегда плотные. В разреженный вид массив
+    // переходит при доле ненулевых не больше 1/sparseEnterRatio, обратно в
+    // плотный - когда доля превышает 1/sparseLeaveRatio. Разрыв между
+    // порогами не дает массиву переключаться туда и обратно на каждой записи.
+    static const size_t sparseMinSize = 4096;
+    static const size_t sparseEnterRatio = 32;
+    static const size_t sparseLeaveRatio = 16;
+
+public:
+    // Память берется из resource; он должен жить дольше массива. nullptr -
+    // обычная куча. Буфер переезжает при перемещении и swap вместе
+    // со своим ресурсом.
+    //
+    // Буферы из кучи разделяются копиями (copy-on-write): копирование только
+    // увеличивает атомарный счетчик ссылок, буфер дублируется при первой
+    // записи в любую из копий. Буфер из resource копируется сразу, чтобы
+    // копия не зависела от времени жизни ресурса.
+    //
+    // Новый массив всегда плотный: его обычно заполняют через setValue в
+    // произвольном порядке, а для разреженного вида это вставки в середину.
+    // Разреженный вид выбирается только после массовых операций.
+    DynamicArray(size_t arraySize, std::pmr::memory_resource* resource = nullptr)
+        : size(arraySize), allocated(arraySize), memory(resource), sparse(false), denseView(nullptr) {
+        data = allocateElements(size, true);
+    }
+
+    DynamicArray(size_t arraySize, Uninitialized,
+                 std::pmr::memory_resource* resource = nullptr)
+        : size(arraySize), allocated(arraySize), memory(resource), sparse(false), denseView(nullptr) {
+        data = allocateElements(size);
+    }
+
+    DynamicArray(const DynamicArray& other)
+        : size(other.size), allocated(other.size), memory(nullptr), sparse(other.sparse),
+          sparseIndices(other.sparseIndices), sparseValues(other.sparseValues), denseView(nullptr) {
+        if (other.memory == nullptr || other.sparse) {
+            data = other.data;
+            allocated = other.allocated;
+            retainElements(data);
+            return;
+        }
+        data = allocateElements(size);
+        for (size_t i = 0; i < size; ++i) {
+            data[i] = other.data[i];
+        }
+    }
+
+    DynamicArray(DynamicArray&& other) noexcept
+        : data(other.data), size(other.size), allocated(other.allocated), memory(other.memory),
+          sparse(other.sparse), sparseIndices(std::move(other.sparseIndices)),
+          sparseValues(std::move(other.sparseValues)),
+          denseView(other.denseView.exchange(nullptr, std::memory_order_relaxed)) {
+        other.data = nullptr;
+        other.size = 0;
+        other.allocated = 0;
+        other.sparse = false;
+        other.sparseIndices.clear();
+        other.sparseValues.clear();
+    }
+
+    virtual ~DynamicArray() {
+        dropDenseView();
+        releaseElements(data, allocated);
+    }
+
+    void print() const {
+        std::cout << "Массив [размер: " << size << "]: ";
+        size_t i = 0;
+        forEachValue([&](int value) {
+            std::cout << value;
+            if (++i < size) {
+                std::cout << ", ";
+            }
+        });
+        std::cout << std::endl;
+    }
+
+    void setValue(size_t index, int value) {
+        if (index >= size) {
+            throw std::out_of_range("Индекс выходит за границы массива");
+        }
+        if (value < -100 || value > 100) {
+            throw std::invalid_argument("Значение должно быть в диапазоне от -100 до 100");
+        }
+        if (sparse) {
+            setSparseValue(index, value);
+            return;
+        }
+        makeUnique();
+        data[index] = value;
+    }
+
+    int getValue(size_t index) const {
+        if (index >= size) {
+            throw std::out_of_range("Индекс выходит за границы массива");
+        }
+        return (*this)[index];
+    }
+
+    // Доступ без проверки границ для быстрых циклов. Ввод пользователя
+    // по-прежнему идет через setValue/getValue; запись в обход проверки
+    // диапазона не предоставляется.
+    //
+    // getData, begin/end и view отдают плотный буфер. Неконстантные версии
+    // переводят разреженный массив в плотный вид. Константные представление
+    // не меняют: для разреженного массива они отдают его плотную копию,
+    // которая живет до следующего изменения массива, как и обычный буфер.
+    typedef const int* const_iterator;
+    typedef const_iterator iterator;
+
+    int operator[](size_t index) const {
+        if (!sparse) {
+            return data[index];
+        }
+        size_t position = sparsePosition(index);
+        if (position < sparseIndices.size() && sparseIndices[position] == index) {
+            return sparseValues[position];
+        }
+        return 0;
+    }
+
+    const int* getData() const {
+        return denseData();
+    }
+
+    const int* getData() {
+        makeDense();
+        return data;
+    }
+
+    const_iterator begin() const {
+        return denseData();
+    }
+
+    const_iterator begin() {
+        makeDense();
+        return data;
+    }
+
+    const_iterator end() const {
+        return denseData() + size;
+    }
+
+    const_iterator end() {
+        makeDense();
+        return data + size;
+    }
+
+#ifdef __cpp_lib_span
+    std::span<const int> view() const {
+        return std::span<const int>(denseData(), size);
+    }
+
+    std::span<const int> view() {
+        makeDense();
+        return std::span<const int>(data, size);
+    }
+#endif
+
+    bool isSparse() const {
+        return sparse;
+    }
+
+    void makeDense() {
+        if (sparse) {
+            leaveSparse();
+        }
+    }
+
+    void pushBack(int value) {
+        if (value < -100 || value > 100) {
+            throw std::invalid_argument("Значение должно быть в диапазоне от -100 до 100");
+        }
+
+        if (sparse) {
+            setSparseValue(size++, value);
+            return;
+        }
+        if (size == allocated) {
+            reserve(allocated > 0 ? allocated * 2 : 1);
+        } else {
+            makeUnique();
+        }
+        data[size++] = value;
+    }
+
+    // У разреженного массива нет плотного буфера, который стоило бы
+    // заранее расширять
+    void reserve(size_t newCapacity) {
+        if (sparse || newCapacity <= allocated) {
+            return;
+        }
+
+        int* newData = allocateElements(newCapacity);
+        for (size_t i = 0; i < size; ++i) {
+            newData[i] = data[i];
+        }
+
+        releaseElements(data, allocated);
+        data = newData;
+        allocated = newCapacity;
+    }
+
+    void shrinkToFit() {
+        if (sparse) {
+            sparseIndices.shrink_to_fit();
+            sparseValues.shrink_to_fit();
+            return;
+        }
+        if (allocated == size) {
+            return;
+        }
+
+        int* newData = allocateElements(size);
+        for (size_t i = 0; i < size; ++i) {
+            newData[i] = data[i];
+        }
+
+        releaseElements(data, allocated);
+        data = newData;
+        allocated = size;
+    }
+
+    // Пакетное заполнение: весь буфер проверяется одним векторным проходом
+    // до изменения массива, при ошибке массив остается прежним. Память
+    // перераспределяется не больше одного раза. Буфер не должен указывать
+    // внутрь самого массива.
+    void appendRange(const int* values, size_t count) {
+        checkRange(values, count);
+        appendValues(values, count);
+    }
+
+    // Заменяет содержимое значениями из [first, last)
+    void assign(const int* first, const int* last) {
+        size_t count = static_cast<size_t>(last - first);
+        checkRange(first, count);
+        if (count >= sparseMinSize && countNonZero(first, count) * sparseEnterRatio <= count) {
+            std::vector<size_t> indices;
+            std::vector<int> values;
+            for (size_t i = 0; i < count; ++i) {
+                if (first[i] != 0) {
+                    indices.push_back(i);
+                    values.push_back(first[i]);
+                }
+            }
+            dropDenseView();
+            releaseElements(data, allocated);
+            data = nullptr;
+            allocated = 0;
+            size = count;
+            sparse = true;
+            sparseIndices.swap(indices);
+            sparseValues.swap(values);
+            return;
+        }
+        if (sparse) {
+            leaveSparse();
+        }
+        if (count > allocated || isShared()) {
+            // Старое содержимое не нужно, поэтому разделяемый буфер
+            // не копируется, а просто заменяется новым
+            size_t newCapacity = (count > allocated) ? count : allocated;
+            int* newData = allocateElements(newCapacity);
+            releaseElements(data, allocated);
+            data = newData;
+            allocated = newCapacity;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            data[i] = first[i];
+        }
+        size = count;
+    }
+
+    // Присваивает value всем элементам
+    void fill(int value) {
+        if (value < -100 || value > 100) {
+            throw std::invalid_argument("Значение должно быть в диапазоне от -100 до 100");
+        }
+        if (value == 0 && size >= sparseMinSize) {
+            clearToSparse(size);
+            return;
+        }
+        if (sparse) {
+            leaveSparse();
+        }
+        makeUnique();
+        for (size_t i = 0; i < size; ++i) {
+            data[i] = value;
+        }
+    }
+
+    size_t getSize() const {
+        return size;
+    }
+
+    // Разреженный массив вмещает все свои size элементов без перевыделения
+    size_t capacity() const {
+        return sparse ? size : allocated;
+    }
+
+    DynamicArray& operator=(const DynamicArray& other) {
+        if (this != &other) {
+            std::vector<size_t> indices(other.sparseIndices);
+            std::vector<int> values(other.sparseValues);
+            dropDenseView();
+
+            if (other.sparse || (memory == nullptr && other.memory == nullptr)) {
+                retainElements(other.data);
+                releaseElements(data, allocated);
+                data = other.data;
+                allocated = other.allocated;
+            } else {
+                int* newData = allocateElements(other.size);
+                for (size_t i = 0; i < other.size; ++i) {
+                    newData[i] = other.data[i];
+                }
+
+                releaseElements(data, allocated);
+                data = newData;
+                allocated = other.size;
+            }
+            size = other.size;
+            sparse = other.sparse;
+            sparseIndices.swap(indices);
+            sparseValues.swap(values);
+        }
+        return *this;
+    }
+
+    DynamicArray& operator=(DynamicArray&& other) noexcept {
+        if (this != &other) {
+            dropDenseView();
+            releaseElements(data, allocated);
+            denseView.store(other.denseView.exchange(nullptr, std::memory_order_relaxed),
+                            std::memory_order_relaxed);
+            data = other.data;
+            size = other.size;
+            allocated = other.allocated;
+            memory = other.memory;
+            sparse = other.sparse;
+            sparseIndices = std::move(other.sparseIndices);
+            sparseValues = std::move(other.sparseValues);
+            other.data = nullptr;
+            other.size = 0;
+            other.allocated = 0;
+            other.sparse = false;
+            other.sparseIndices.clear();
+            other.sparseValues.clear();
+        }
+        return *this;
+    }
+
+    void swap(DynamicArray& other) noexcept {
+        std::swap(data, other.data);
+        std::swap(size, other.size);
+        std::swap(allocated, other.allocated);
+        std::swap(memory, other.memory);
+        std::swap(sparse, other.sparse);
+        sparseIndices.swap(other.sparseIndices);
+        sparseValues.swap(other.sparseValues);
+        int* view = denseView.load(std::memory_order_relaxed);
+        denseView.store(other.denseView.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        other.denseView.store(view, std::memory_order_relaxed);
+    }
+
+    std::pmr::memory_resource* getMemoryResource() const {
+        return memory;
+    }
+
+    virtual void saveToFile() const = 0;
+
+    virtual std::unique_ptr<DynamicArray> clone() const = 0;
+
+    // Снимает копию массива и пишет ее в фоновом потоке; массив можно
+    // менять сразу после вызова, в файл попадет состояние на момент вызова
+    std::future<void> saveToFileAsync() const {
+        std::shared_ptr<const DynamicArray> snapshot(clone());
+        return AsyncSaveQueue::instance().submit([snapshot] { snapshot->saveToFile(); });
+    }
+
+protected:
+    // Результат разреженный, если разрежены оба операнда: тогда их пары
+    // сливаются за один проход, как при слиянии отсортированных списков
+    static bool sparseResult(const DynamicArray& lhs, const DynamicArray& rhs) {
+        return lhs.sparse && rhs.sparse;
+    }
+
+    // Общая часть плотных массивов считается векторным ядром, хвост более
+    // длинного операнда уже лежит в диапазоне и копируется без насыщения.
+    // Если плотный только один операнд, левый разворачивается прямо в
+    // результат, а правый накладывается поверх.
+    template <bool Subtract>
+    static void combineInto(const DynamicArray& lhs, const DynamicArray& rhs, DynamicArray& result) {
+        if (result.sparse) {
+            mergeSparse<Subtract>(lhs, rhs, result);
+            return;
+        }
+        if (lhs.sparse || rhs.sparse) {
+            lhs.copyValues(0, lhs.size, result.data);
+            std::memset(result.data + lhs.size, 0, (result.size - lhs.size) * sizeof(int));
+            if (!rhs.sparse) {
+                if (rhs.size > 0) {
+                    selectSaturatingKernel<Subtract>()(result.data, rhs.data, result.data, rhs.size);
+                }
+                return;
+            }
+            for (size_t k = 0; k < rhs.sparseIndices.size(); ++k) {
+                int* target = result.data + rhs.sparseIndices[k];
+                saturateScalar<Subtract>(target, &rhs.sparseValues[k], target, 1);
+            }
+            return;
+        }
+
+        size_t overlap = (lhs.size < rhs.size) ? lhs.size : rhs.size;
+        if (overlap > 0) {
+            selectSaturatingKernel<Subtract>()(lhs.data, rhs.data, result.data, overlap);
+        }
+        for (size_t i = overlap; i < lhs.size; ++i) {
+            result.data[i] = lhs.data[i];
+        }
+        for (size_t i = overlap; i < rhs.size; ++i) {
+            result.data[i] = Subtract ? -rhs.data[i] : rhs.data[i];
+        }
+    }
+
+    // Перед элементами буфера лежит счетчик ссылок. Уменьшение идет с
+    // acq_rel, чтобы освобождение буфера видело все чтения других владельцев.
+    // mappedBytes - длина отображения ОС, 0 для памяти из кучи или resource.
+    struct BufferHeader {
+        std::atomic<size_t> references;
+        size_t mappedBytes;
+    };
+
+    static BufferHeader* headerOf(const int* elements) {
+        return reinterpret_cast<BufferHeader*>(const_cast<int*>(elements)) - 1;
+    }
+
+    // zeroed - элементы должны быть нулями. Большие буферы из кучи
+    // отображаются через mmap и нулевые сразу; память из resource
+    // обнуляется явно, так как ресурс может вернуть уже использованный блок.
+    int* allocateElements(size_t count, bool zeroed = false) const {
+        if (count == 0) {
+            return nullptr;
+        }
+        if (count > (SIZE_MAX - sizeof(BufferHeader)) / sizeof(int)) {
+            throw std::bad_array_new_length();
+        }
+        size_t bytes = sizeof(BufferHeader) + count * sizeof(int);
+        size_t mappedBytes = 0;
+        void* block = nullptr;
+        if (memory != nullptr) {
+            block = memory->allocate(bytes, alignof(BufferHeader));
+            if (zeroed) {
+                std::memset(block, 0, bytes);
+            }
+        } else {
+            if (bytes >= lazyZeroThreshold) {
+                block = mapZeroedPages(bytes);
+                mappedBytes = (block != nullptr) ? bytes : 0;
+            }
+            if (block == nullptr) {
+                block = zeroed ? std::calloc(1, bytes) : std::malloc(bytes);
+                if (block == nullptr) {
+                    throw std::bad_alloc();
+                }
+            }
+        }
+        BufferHeader* header = new (block) BufferHeader;
+        header->references.store(1, std::memory_order_relaxed);
+        header->mappedBytes = mappedBytes;
+        return reinterpret_cast<int*>(header + 1);
+    }
+
+    static void retainElements(int* elements) {
+        if (elements != nullptr) {
+            headerOf(elements)->references.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void releaseElements(int* elements, size_t count) const {
+        if (elements == nullptr) {
+            return;
+        }
+        BufferHeader* header = headerOf(elements);
+        if (header->references.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+            return;
+        }
+        size_t mappedBytes = header->mappedBytes;
+        header->~BufferHeader();
+        if (mappedBytes > 0) {
+            unmapPages(header, mappedBytes);
+        } else if (memory == nullptr) {
+            std::free(header);
+        } else {
+            memory->deallocate(header, sizeof(BufferHeader) + count * sizeof(int), alignof(BufferHeader));
+        }
+    }
+
+    bool isShared() const {
+        return data != nullptr && headerOf(data)->references.load(std::memory_order_acquire) > 1;
+    }
+
+    // Вызывается перед любой записью в буфер: разделяемый буфер
+    // копируется с той же емкостью, и дальше массив пишет только в свой
+    void makeUnique() {
+        if (!isShared()) {
+            return;
+        }
+        int* newData = allocateElements(allocated);
+        std::memcpy(newData, data, size * sizeof(int));
+        releaseElements(data, allocated);
+        data = newData;
+    }
+
+    static void checkRange(const int* values, size_t count) {
+        size_t bad = selectRangeCheckKernel()(values, count);
+        if (bad < count) {
+            throw std::invalid_argument("Значение с индексом " + std::to_string(bad) + " должно быть в диапазоне от -100 до 100");
+        }
+    }
+
+    template <bool Subtract>
+    static void mergeSparse(const DynamicArray& lhs, const DynamicArray& rhs, DynamicArray& result) {
+        const std::vector<size_t>& leftIndices = lhs.sparseIndices;
+        const std::vector<size_t>& rightIndices = rhs.sparseIndices;
+        std::vector<size_t> indices;
+        std::vector<int> values;
+        indices.reserve(leftIndices.size() + rightIndices.size());
+        values.reserve(leftIndices.size() + rightIndices.size());
+
+        size_t left = 0;
+        size_t right = 0;
+        while (left < leftIndices.size() || right < rightIndices.size()) {
+            size_t index;
+            int value;
+            if (right == rightIndices.size() ||
+                (left < leftIndices.size() && leftIndices[left] < rightIndices[right])) {
+                index = leftIndices[left];
+                value = lhs.sparseValues[left++];
+            } else if (left == leftIndices.size() || rightIndices[right] < leftIndices[left]) {
+                index = rightIndices[right];
+                value = Subtract ? -rhs.sparseValues[right] : rhs.sparseValues[right];
+                ++right;
+            } else {
+                index = leftIndices[left];
+                saturateScalar<Subtract>(&lhs.sparseValues[left], &rhs.sparseValues[right], &value, 1);
+                ++left;
+                ++right;
+            }
+            if (value != 0) {
+                indices.push_back(index);
+                values.push_back(value);
+            }
+        }
+
+        result.sparseIndices.swap(indices);
+        result.sparseValues.swap(values);
+        if (result.sparseValues.size() * sparseLeaveRatio > result.size) {
+            result.leaveSparse();
+        }
+    }
+
+    // Позиция первой пары с индексом не меньше index
+    size_t sparsePosition(size_t index) const {
+        return static_cast<size_t>(std::lower_bound(sparseIndices.begin(), sparseIndices.end(), index) -
+                                   sparseIndices.begin());
+    }
+
+    // Разреженный вид держит только дешевые записи: замену существующей
+    // пары и добавление или удаление пары в конце. Запись, которая сдвинула
+    // бы пары в середине, сначала переводит массив в плотный вид, поэтому
+    // каждая запись стоит O(log nnz), а не O(nnz).
+    void setSparseValue(size_t index, int value) {
+        dropDenseView();
+        size_t position = sparsePosition(index);
+        bool found = position < sparseIndices.size() && sparseIndices[position] == index;
+        if (found && value != 0) {
+            sparseValues[position] = value;
+            return;
+        }
+        if (!found && value == 0) {
+            return;
+        }
+        if (found && position + 1 == sparseIndices.size()) {
+            sparseIndices.pop_back();
+            sparseValues.pop_back();
+            return;
+        }
+        if (found || position < sparseIndices.size()) {
+            leaveSparse();
+            makeUnique();
+            data[index] = value;
+            return;
+        }
+        reserveSparsePair();
+        sparseIndices.push_back(index);
+        sparseValues.push_back(value);
+        if (sparseValues.size() * sparseLeaveRatio > size) {
+            leaveSparse();
+        }
+    }
+
+    // Делает массив пустым разреженным массивом из newSize нулей
+    void clearToSparse(size_t newSize) {
+        dropDenseView();
+        releaseElements(data, allocated);
+        data = nullptr;
+        allocated = 0;
+        size = newSize;
+        sparse = true;
+        sparseIndices.clear();
+        sparseValues.clear();
+    }
+
+    // Место под пару резервируется заранее, чтобы добавление в два вектора
+    // не могло оборваться посередине
+    void reserveSparsePair() {
+        if (sparseIndices.size() == sparseIndices.capacity() || sparseValues.size() == sparseValues.capacity()) {
+            size_t grown = sparseIndices.size() * 2 + 1;
+            sparseIndices.reserve(grown);
+            sparseValues.reserve(grown);
+        }
+    }
+
+    // Переводит разреженный массив в плотный вид: нулевой буфер берется
+    // готовым, записываются только ненулевые значения
+    void leaveSparse() {
+        dropDenseView();
+        int* newData = allocateElements(size, true);
+        for (size_t i = 0; i < sparseIndices.size(); ++i) {
+            newData[sparseIndices[i]] = sparseValues[i];
+        }
+        data = newData;
+        allocated = size;
+        sparse = false;
+        std::vector<size_t>().swap(sparseIndices);
+        std::vector<int>().swap(sparseValues);
+    }
+
+    // Переводит плотный массив в разреженный вид, если ненулевых мало.
+    // Вызывается после массовой загрузки, когда плотность уже известна.
+    void chooseStorage() {
+        if (sparse || size < sparseMinSize) {
+            return;
+        }
+        size_t nonZero = countNonZero(data, size);
+        if (nonZero * sparseEnterRatio > size) {
+            return;
+        }
+        std::vector<size_t> indices;
+        std::vector<int> values;
+        indices.reserve(nonZero);
+        values.reserve(nonZero);
+        for (size_t i = 0; i < size; ++i) {
+            if (data[i] != 0) {
+                indices.push_back(i);
+                values.push_back(data[i]);
+            }
+        }
+        releaseElements(data, allocated);
+        data = nullptr;
+        allocated = 0;
+        sparse = true;
+        sparseIndices.swap(indices);
+        sparseValues.swap(values);
+    }
+
+    static size_t countNonZero(const int* values, size_t count) {
+        size_t nonZero = 0;
+        for (size_t i = 0; i < count; ++i) {
+            nonZero += (values[i] != 0);
+        }
+        return nonZero;
+    }
+
+    // Разворачивает элементы [first, first + count) в плотный буфер out
+    void copyValues(size_t first, size_t count, int* out) const {
+        if (count == 0) {
+            return;
+        }
+        if (!sparse) {
+            std::memcpy(out, data + first, count * sizeof(int));
+            return;
+        }
+        std::memset(out, 0, count * sizeof(int));
+        for (size_t k = sparsePosition(first); k < sparseIndices.size() && sparseIndices[k] < first + count; ++k) {
+            out[sparseIndices[k] - first] = sparseValues[k];
+        }
+    }
+
+    // Обходит все элементы по порядку, не разворачивая разреженный массив
+    template <typename Visitor>
+    void forEachValue(Visitor visit) const {
+        if (!sparse) {
+            for (size_t i = 0; i < size; ++i) {
+                visit(data[i]);
+            }
+            return;
+        }
+        size_t next = 0;
+        for (size_t i = 0; i < size; ++i) {
+            if (next < sparseIndices.size() && sparseIndices[next] == i) {
+                visit(sparseValues[next++]);
+            } else {
+                visit(0);
+            }
+        }
+    }
+
+    // Плотная копия строится без блокировки: если два читателя построили
+    // ее одновременно, публикуется одна, вторая освобождается
+    const int* denseData() const {
+        if (!sparse) {
+            return data;
+        }
+        int* view = denseView.load(std::memory_order_acquire);
+        if (view != nullptr || size == 0) {
+            return view;
+        }
+        int* built = static_cast<int*>(std::calloc(size, sizeof(int)));
+        if (built == nullptr) {
+            throw std::bad_alloc();
+        }
+        for (size_t i = 0; i < sparseIndices.size(); ++i) {
+            built[sparseIndices[i]] = sparseValues[i];
+        }
+        if (denseView.compare_exchange_strong(view, built, std::memory_order_acq_rel,
+                                              std::memory_order_acquire)) {
+            return built;
+        }
+        std::free(built);
+        return view;
+    }
+
+    void dropDenseView() {
+        std::free(denseView.exchange(nullptr, std::memory_order_relaxed));
+    }
+
+    // Добавляет в конец уже проверенные значения одной копией
+    void appendValues(const int* values, size_t count) {
+        if (sparse) {
+            dropDenseView();
+            for (size_t i = 0; i < count; ++i) {
+                if (values[i] != 0) {
+                    reserveSparsePair();
+                    sparseIndices.push_back(size + i);
+                    sparseValues.push_back(values[i]);
+                }
+            }
+            size += count;
+            if (sparseValues.size() * sparseLeaveRatio > size) {
+                leaveSparse();
+            }
+            return;
+        }
+        if (size + count > allocated) {
+            size_t grown = allocated * 2;
+            reserve((grown > size + count) ? grown : size + count);
+        } else {
+            makeUnique();
+        }
+        std::memcpy(data + size, values, count * sizeof(int));
+        size += count;
+    }
+
+    std::string getCurrentDateTime() const {
+        auto now = std::chrono::system_clock::now();
+        auto time_t = std::chrono::system_clock::to_time_t(now);
+        long long nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            now.time_since_epoch()).count() % 1000000000;
+        
+        std::tm local = {};
+#ifdef _WIN32
+        localtime_s(&local, &time_t);
+#else
+        localtime_r(&time_t, &local);
+#endif
+        std::stringstream ss;
+        ss << std::put_time(&local, "%Y-%m-%d_%H-%M-%S") << '_'
+           << std::setw(9) << std::setfill('0') << nanoseconds;
+        return ss.str();
+    }
+
+    // Время с наносекундами, идентификатор процесса и номер сохранения
+    // внутри процесса: имена не совпадают даже при тысячах сохранений в секунду
+    std::string makeOutputFilename(const std::string& extension) const {
+        std::stringstream ss;
+        ss << getCurrentDateTime() << '_' << currentProcessId() << '_' << nextSaveSequence() << extension;
+        return ss.str();
+    }
+
+    static unsigned long long nextSaveSequence() {
+        static std::atomic<unsigned long long> sequence(0);
+        return sequence++;
+    }
+
+    static unsigned long currentProcessId() {
+#ifdef _WIN32
+        return static_cast<unsigned long>(GetCurrentProcessId());
+#else
+        return static_cast<unsigned long>(getpid());
+#endif
+    }
+
+    // Файл пишется под временным именем и переименовывается после успешного
+    // закрытия, поэтому под итоговым именем никогда не лежит недописанный файл
+    template <typename Writer>
+    static void commitFile(const std::string& filename, std::ios::openmode mode, Writer write) {
+        std::string temporary = filename + "." + std::to_string(nextSaveSequence()) + ".tmp";
+        {
+            std::ofstream file(temporary, mode);
+            if (!file.is_open()) {
+                throw std::runtime_error("Не удалось открыть файл для записи: " + temporary);
+            }
+            write(file);
+            file.close();
+            if (!file) {
+                std::remove(temporary.c_str());
+                throw std::runtime_error("Ошибка записи в файл: " + temporary);
+            }
+        }
+#ifdef _WIN32
+        bool renamed = MoveFileExA(temporary.c_str(), filename.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+        bool renamed = std::rename(temporary.c_str(), filename.c_str()) == 0;
+#endif
+        if (!renamed) {
+            std::remove(temporary.c_str());
+            throw std::runtime_error("Не удалось переименовать файл в " + filename);
+        }
+    }
+};
+
+// Десятичная запись индекса, который при сохранении растет на единицу:
+// инкремент меняет последние цифры вместо деления на 10 для каждого числа
+class DecimalCounter {
+public:
+    DecimalCounter() : start(sizeof(digits) - 1) {
+        digits[start] = '0';
+    }
+
+    void increment() {
+        size_t i = sizeof(digits);
+        for (;;) {
+            --i;
+            if (i < start) {
+                start = i;
+                digits[i] = '1';
+                return;
+            }
+            if (digits[i] != '9') {
+                ++digits[i];
+                return;
+            }
+            digits[i] = '0';
+        }
+    }
+
+    const char* text() const {
+        return digits + start;
+    }
+
+    size_t length() const {
+        return sizeof(digits) - start;
+    }
+
+private:
+    char digits[20];
+    size_t start;
+};
+
+// Текст всех допустимых значений [-100, 100], построенный один раз
+struct ValueText {
+    char text[4];
+    size_t length;
+};
+
+inline const ValueText* valueTexts() {
+    static const struct Table {
+        ValueText entries[201];
+
+        Table() {
+            for (int value = -100; value <= 100; ++value) {
+                std::string text = std::to_string(value);
+                ValueText& entry = entries[value + 100];
+                std::memcpy(entry.text, text.data(), text.size());
+                entry.length = text.size();
+            }
+        }
+    } table;
+    return table.entries;
+}
+
+// Собирает текст в большом буфере и отдает его в файл одним write на блок
+class BlockWriter {
+public:
+    static const size_t bufferSize = size_t(1) << 20;
+    // Самое длинное значение int: "-2147483648"
+    static const size_t maxValueLength = 11;
+
+    explicit BlockWriter(std::ofstream& file) : out(file), buffer(new char[bufferSize]), used(0) {}
+
+    // Гарантирует место под length байт без промежуточных проверок
+    void reserve(size_t length) {
+        if (used + length > bufferSize) {
+            flush();
+        }
+    }
+
+    void append(const char* text, size_t length) {
+        reserve(length);
+        appendUnchecked(text, length);
+    }
+
+    void append(const std::string& text) {
+        append(text.data(), text.size());
+    }
+
+    void appendUnchecked(const char* text, size_t length) {
+        std::memcpy(buffer.get() + used, text, length);
+        used += length;
+    }
+
+    void appendUnchecked(char symbol) {
+        buffer[used++] = symbol;
+    }
+
+    // Вызывающий резервирует maxValueLength байт. Массив, созданный с
+    // Uninitialized и заполненный не до конца, может содержать значения вне
+    // [-100, 100]; для них общий путь вместо чтения за границей таблицы.
+    void appendValue(int value) {
+        if (value < -100 || value > 100) {
+            char* position = buffer.get() + used;
+            char* last = std::to_chars(position, position + maxValueLength, value).ptr;
+            used += static_cast<size_t>(last - position);
+            return;
+        }
+        const ValueText& entry = valueTexts()[value + 100];
+        appendUnchecked(entry.text, entry.length);
+    }
+
+    void flush() {
+        if (used > 0) {
+            out.write(buffer.get(), static_cast<std::streamsize>(used));
+            used = 0;
+        }
+    }
+
+private:
+    std::ofstream& out;
+    std::unique_ptr<char[]> buffer;
+    size_t used;
+};
+
+enum class TextFormat { Txt, Csv };
+
+// Результат разбора одного участка файла. Ошибки не бросаются из рабочих
+// потоков, а запоминаются и проверяются после объединения участков.
+struct ParsedPart {
+    std::vector<int> values;
+    size_t firstIndex = 0;
+    int minValue = 0;
+    int maxValue = 0;
+    bool malformed = false;
+};
+
+// Неотрицательное число без знака; не более 19 цифр
+inline bool parseUnsigned(const char*& p, const char* end, size_t& result) {
+    const char* start = p;
+    size_t value = 0;
+    while (p < end && *p >= '0' && *p <= '9' && p - start < 19) {
+        value = value * 10 + static_cast<size_t>(*p - '0');
+        ++p;
+    }
+    result = value;
+    return p > start;
+}
+
+// Число со знаком до 9 цифр; выход за [-100, 100] проверяется позже пачкой
+inline bool parseSigned(const char*& p, const char* end, int& result) {
+    bool negative = (p < end && *p == '-');
+    if (negative) {
+        ++p;
+    }
+    const char* start = p;
+    int value = 0;
+    while (p < end && *p >= '0' && *p <= '9' && p - start < 9) {
+        value = value * 10 + (*p - '0');
+        ++p;
+    }
+    result = negative ? -value : value;
+    return p > start;
+}
+
+// Разбирает строки "Элемент i: v" или "i,v" из [begin, end). Строки
+// разделены '\n', допускается '\r' перед ним и пустые строки.
+inline void parseLines(const char* begin, const char* end, TextFormat format, ParsedPart& part) {
+    static const char prefix[] = "Элемент ";
+    const size_t prefixLength = sizeof(prefix) - 1;
+    size_t expectedLength = (format == TextFormat::Csv) ? 6 : 20;
+    part.values.reserve(static_cast<size_t>(end - begin) / expectedLength + 1);
+    part.minValue = 0;
+    part.maxValue = 0;
+
+    const char* p = begin;
+    while (p < end) {
+        const char* newline = static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(end - p)));
+        const char* lineEnd = (newline != nullptr) ? newline : end;
+        const char* stop = (lineEnd > p && lineEnd[-1] == '\r') ? lineEnd - 1 : lineEnd;
+
+        if (stop > p) {
+            size_t index = 0;
+            int value = 0;
+            bool ok;
+            if (format == TextFormat::Csv) {
+                ok = parseUnsigned(p, stop, index) && p < stop && *p++ == ',' &&
+                     parseSigned(p, stop, value) && p == stop;
+            } else {
+                ok = static_cast<size_t>(stop - p) > prefixLength &&
+                     std::memcmp(p, prefix, prefixLength) == 0;
+                if (ok) {
+                    p += prefixLength;
+                    ok = parseUnsigned(p, stop, index) && stop - p > 2 && p[0] == ':' && p[1] == ' ';
+                }
+                if (ok) {
+                    p += 2;
+                    ok = parseSigned(p, stop, value) && p == stop;
+                }
+            }
+
+            if (part.values.empty()) {
+                part.firstIndex = index;
+            }
+            if (!ok || index != part.firstIndex + part.values.size()) {
+                part.malformed = true;
+                return;
+            }
+            part.values.push_back(value);
+            part.minValue = (value < part.minValue) ? value : part.minValue;
+            part.maxValue = (value > part.maxValue) ? value : part.maxValue;
+        }
+        p = lineEnd + 1;
+    }
+}
+
+// Потоковая загрузка файлов ArrTxt/ArrCSV. Файл читается кусками по
+// chunkSize байт; полные строки куска делятся по границам строк между
+// потоками, остаток последней строки переносится в следующий кусок.
+// reserve получает размер из заголовка TXT, append - проверенные значения
+// в порядке файла. Размер из заголовка не может превышать число строк,
+// которое помещается в файл, поэтому память под него ограничена размером
+// файла.
+template <typename Reserve, typename Append>
+void loadTextArray(const std::string& filename, TextFormat format, Reserve reserve, Append append) {
+    const size_t chunkSize = size_t(64) << 20;
+    const size_t minPartSize = size_t(1) << 20;
+
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Не удалось открыть файл для чтения: " + filename);
+    }
+    file.seekg(0, std::ios::end);
+    uint64_t fileSize = static_cast<uint64_t>(file.tellg());
+    file.seekg(0);
+
+    size_t threadCount = std::thread::hardware_concurrency();
+    if (threadCount == 0) {
+        threadCount = 1;
+    }
+
+    std::vector<char> buffer;
+    size_t carried = 0;
+    bool headerParsed = false;
+    bool sizeDeclared = false;
+    size_t declaredSize = 0;
+    size_t loaded = 0;
+
+    for (;;) {
+        buffer.resize(carried + chunkSize);
+        file.read(buffer.data() + carried, static_cast<std::streamsize>(chunkSize));
+        size_t filled = carried + static_cast<size_t>(file.gcount());
+        bool lastChunk = !file;
+
+        const char* begin = buffer.data();
+        const char* end = begin + filled;
+        const char* parseEnd = end;
+        if (!lastChunk) {
+            while (parseEnd > begin && parseEnd[-1] != '\n') {
+                --parseEnd;
+            }
+            if (parseEnd == begin) {
+                carried = filled;
+                continue;
+            }
+        }
+
+        if (!headerParsed) {
+            const char* newline = static_cast<const char*>(std::memchr(begin, '\n', static_cast<size_t>(parseEnd - begin)));
+            const char* headerEnd = (newline != nullptr) ? newline : parseEnd;
+            std::string header(begin, headerEnd);
+            if (!header.empty() && header.back() == '\r') {
+                header.pop_back();
+            }
+            if (format == TextFormat::Csv) {
+                if (header != "Index,Value") {
+                    throw std::runtime_error("Неверный заголовок CSV в файле: " + filename);
+                }
+            } else {
+                static const char txtPrefix[] = "Массив [размер: ";
+                const char* p = header.data() + (sizeof(txtPrefix) - 1);
+                const char* stop = header.data() + header.size();
+                if (header.compare(0, sizeof(txtPrefix) - 1, txtPrefix) != 0 ||
+                    !parseUnsigned(p, stop, declaredSize) || stop - p != 2 || p[0] != ']' || p[1] != ':') {
+                    throw std::runtime_error("Неверный заголовок TXT в файле: " + filename);
+                }
+                static const char shortestLine[] = "Элемент 0: 0";
+                if (declaredSize > fileSize / (sizeof(shortestLine) - 1)) {
+                    throw std::runtime_error("Число элементов не совпадает с заголовком в файле: " + filename);
+                }
+                sizeDeclared = true;
+                reserve(declaredSize);
+            }
+            headerParsed = true;
+            begin = (newline != nullptr) ? newline + 1 : parseEnd;
+        }
+
+        size_t bytes = static_cast<size_t>(parseEnd - begin);
+        size_t partCount = bytes / minPartSize;
+        partCount = (partCount < 1) ? 1 : (partCount > threadCount ? threadCount : partCount);
+
+        std::vector<const char*> bounds(partCount + 1, parseEnd);
+        bounds[0] = begin;
+        for (size_t i = 1; i < partCount; ++i) {
+            const char* target = begin + bytes / partCount * i;
+            target = (target < bounds[i - 1]) ? bounds[i - 1] : target;
+            const char* newline = static_cast<const char*>(std::memchr(target, '\n', static_cast<size_t>(parseEnd - target)));
+            bounds[i] = (newline != nullptr) ? newline + 1 : parseEnd;
+        }
+
+        std::vector<ParsedPart> parts(partCount);
+        std::vector<std::thread> workers;
+        for (size_t i = 1; i < partCount; ++i) {
+            workers.emplace_back([&, i] { parseLines(bounds[i], bounds[i + 1], format, parts[i]); });
+        }
+        parseLines(bounds[0], bounds[1], format, parts[0]);
+        for (size_t i = 0; i < workers.size(); ++i) {
+            workers[i].join();
+        }
+
+        for (size_t i = 0; i < partCount; ++i) {
+            ParsedPart& part = parts[i];
+            if (part.malformed || (!part.values.empty() && part.firstIndex != loaded)) {
+                size_t position = loaded + (part.malformed ? part.values.size() : 0);
+                throw std::runtime_error("Некорректная строка для элемента " + std::to_string(position) +
+                                         " в файле: " + filename);
+            }
+            if (part.minValue < -100 || part.maxValue > 100) {
+                size_t offending = 0;
+                while (part.values[offending] >= -100 && part.values[offending] <= 100) {
+                    ++offending;
+                }
+                throw std::invalid_argument("Значение элемента " + std::to_string(loaded + offending) +
+                                            " вне диапазона от -100 до 100 в файле: " + filename);
+            }
+            if (!part.values.empty()) {
+                append(part.values.data(), part.values.size());
+                loaded += part.values.size();
+            }
+        }
 
+        carried = static_cast<size_t>(end - parseEnd);
+        std::memmove(buffer.data(), parseEnd, carried);
+        if (lastChunk) {
+            break;
+        }
+    }
+
+    if (sizeDeclared && declaredSize != loaded) {
+        throw std::runtime_error("Число элементов не совпадает с заголовком в файле: " + filename);
+    }
+}
+
+// Общая часть всех форматов. Format - конкретный класс (ArrTxt, ArrCSV, ...),
+// который определяет только сохранение. Арифметика написана один раз, без
+// виртуальных вызовов в цикле; результат имеет тип левого операнда и
+// возвращается по значению.
+template <typename Format>
+class FormattedArray : public DynamicArray {
 public:
-    DynamicArray(size_t arraySize) : size(arraySize) {
-        if (size > 0) {
-            data = new int[size];
-            for (size_t i = 0; i < size; ++i) {
-                data[i] = 0;
-            }
-        } else {
-            data = nullptr;
+    FormattedArray(size_t arraySize, std::pmr::memory_resource* resource = nullptr)
+        : DynamicArray(arraySize, resource) {}
+
+    FormattedArray(size_t arraySize, Uninitialized tag,
+                   std::pmr::memory_resource* resource = nullptr)
+        : DynamicArray(arraySize, tag, resource) {}
+
+    FormattedArray(const DynamicArray& other) : DynamicArray(other) {}
+
+    FormattedArray(DynamicArray&& other) noexcept : DynamicArray(std::move(other)) {}
+
+    Format add(const DynamicArray& other,
+               std::pmr::memory_resource* resource = nullptr) const {
+        size_t maxSize = (size > other.getSize()) ? size : other.getSize();
+        if (sparseResult(*this, other)) {
+            Format result(0, resource);
+            result.clearToSparse(maxSize);
+            combineInto<false>(*this, other, result);
+            return result;
         }
+
+        Format result(maxSize, Uninitialized(), resource);
+        combineInto<false>(*this, other, result);
+
+        return result;
     }
 
-    DynamicArray(const DynamicArray& other) : size(other.size) {
-        if (size > 0) {
-            data = new int[size];
-            for (size_t i = 0; i < size; ++i) {
-                data[i] = other.data[i];
-            }
-        } else {
-            data = nullptr;
+    Format subtract(const DynamicArray& other,
+                    std::pmr::memory_resource* resource = nullptr) const {
+        size_t maxSize = (size > other.getSize()) ? size : other.getSize();
+        if (sparseResult(*this, other)) {
+            Format result(0, resource);
+            result.clearToSparse(maxSize);
+            combineInto<true>(*this, other, result);
+            return result;
         }
+
+        Format result(maxSize, Uninitialized(), resource);
+        combineInto<true>(*this, other, result);
+
+        return result;
     }
 
-    virtual ~DynamicArray() {
-        delete[] data;
+    std::unique_ptr<DynamicArray> clone() const override {
+        return std::unique_ptr<DynamicArray>(new Format(static_cast<const Format&>(*this)));
     }
+};
 
-    void print() const {
-        std::cout << "Массив [размер: " << size << "]: ";
-        for (size_t i = 0; i < size; ++i) {
-            std::cout << data[i];
-            if (i < size - 1) {
-                std::cout << ", ";
+class ArrTxt : public FormattedArray<ArrTxt> {
+public:
+    ArrTxt(size_t arraySize, std::pmr::memory_resource* resource = nullptr)
+        : FormattedArray(arraySize, resource) {}
+
+    ArrTxt(size_t arraySize, Uninitialized tag,
+           std::pmr::memory_resource* resource = nullptr)
+        : FormattedArray(arraySize, tag, resource) {}
+    
+    ArrTxt(const DynamicArray& other) : FormattedArray(other) {}
+
+    ArrTxt(DynamicArray&& other) noexcept : FormattedArray(std::move(other)) {}
+
+    static ArrTxt loadFromFile(const std::string& filename) {
+        ArrTxt result(0);
+        loadTextArray(filename, TextFormat::Txt,
+                      [&](size_t expected) { result.reserve(expected); },
+                      [&](const int* values, size_t count) { result.appendValues(values, count); });
+        result.chooseStorage();
+        return result;
+    }
+
+    void saveToFile() const override {
+        std::string filename = makeOutputFilename(".txt");
+        commitFile(filename, std::ios::out, [&](std::ofstream& file) {
+            static const char prefix[] = "Элемент ";
+            BlockWriter writer(file);
+            writer.append("Массив [размер: " + std::to_string(size) + "]:\n");
+            DecimalCounter index;
+            size_t i = 0;
+            forEachValue([&](int value) {
+                writer.reserve(sizeof(prefix) + 20 + 2 + BlockWriter::maxValueLength + 1);
+                writer.appendUnchecked(prefix, sizeof(prefix) - 1);
+                writer.appendUnchecked(index.text(), index.length());
+                writer.appendUnchecked(": ", 2);
+                writer.appendValue(value);
+                if (++i < size) {
+                    writer.appendUnchecked('\n');
+                }
+                index.increment();
+            });
+            writer.flush();
+        });
+        std::cout << "Массив сохранен в файл: " << filename << std::endl;
+    }
+};
+
+class ArrCSV : public FormattedArray<ArrCSV> {
+public:
+    ArrCSV(size_t arraySize, std::pmr::memory_resource* resource = nullptr)
+        : FormattedArray(arraySize, resource) {}
+
+    ArrCSV(size_t arraySize, Uninitialized tag,
+           std::pmr::memory_resource* resource = nullptr)
+        : FormattedArray(arraySize, tag, resource) {}
+    
+    ArrCSV(const DynamicArray& other) : FormattedArray(other) {}
+
+    ArrCSV(DynamicArray&& other) noexcept : FormattedArray(std::move(other)) {}
+
+    static ArrCSV loadFromFile(const std::string& filename) {
+        ArrCSV result(0);
+        loadTextArray(filename, TextFormat::Csv,
+                      [&](size_t expected) { result.reserve(expected); },
+                      [&](const int* values, size_t count) { result.appendValues(values, count); });
+        result.chooseStorage();
+        return result;
+    }
+
+    void saveToFile() const override {
+        std::string filename = makeOutputFilename(".csv");
+        commitFile(filename, std::ios::out, [&](std::ofstream& file) {
+            BlockWriter writer(file);
+            writer.append("Index,Value\n", 12);
+            DecimalCounter index;
+            size_t i = 0;
+            forEachValue([&](int value) {
+                writer.reserve(20 + 1 + BlockWriter::maxValueLength + 1);
+                writer.appendUnchecked(index.text(), index.length());
+                writer.appendUnchecked(',');
+                writer.appendValue(value);
+                if (++i < size) {
+                    writer.appendUnchecked('\n');
+                }
+                index.increment();
+            });
+            writer.flush();
+        });
+        std::cout << "Массив сохранен в файл: " << filename << std::endl;
+    }
+};
+
+// Двоичный формат ArrBin: заголовок фиксированного размера и следом сырые
+// int32 элементы (порядок байт платформы). Контрольная сумма - Fletcher-64
+// по 32-битным словам полезной нагрузки.
+struct BinaryHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t elementWidth;
+    uint32_t reserved;
+    uint64_t count;
+    uint64_t checksum;
+};
+
+static_assert(sizeof(BinaryHeader) == 32, "Заголовок ArrBin должен занимать 32 байта");
+static_assert(sizeof(int) == sizeof(int32_t), "ArrBin рассчитан на 32-битный int");
+
+const char binaryMagic[4] = {'D', 'A', 'R', 'B'};
+const uint32_t binaryVersion = 1;
+
+inline uint64_t binaryChecksum(const int* values, size_t count) {
+    uint64_t low = 0;
+    uint64_t high = 0;
+    for (size_t i = 0; i < count; ++i) {
+        low += static_cast<uint32_t>(values[i]);
+        high += low;
+    }
+    return (high << 32) ^ low;
+}
+
+inline void validateBinaryHeader(const BinaryHeader& header, uint64_t fileSize, const std::string& filename) {
+    if (fileSize < sizeof(BinaryHeader) ||
+        header.magic[0] != binaryMagic[0] || header.magic[1] != binaryMagic[1] ||
+        header.magic[2] != binaryMagic[2] || header.magic[3] != binaryMagic[3]) {
+        throw std::runtime_error("Файл не является массивом ArrBin: " + filename);
+    }
+    if (header.version != binaryVersion) {
+        throw std::runtime_error("Неподдерживаемая версия формата ArrBin: " + filename);
+    }
+    if (header.elementWidth != sizeof(int32_t)) {
+        throw std::runtime_error("Неподдерживаемая ширина элемента в файле: " + filename);
+    }
+    if (header.count > (fileSize - sizeof(BinaryHeader)) / sizeof(int32_t) ||
+        sizeof(BinaryHeader) + header.count * sizeof(int32_t) != fileSize) {
+        throw std::runtime_error("Размер файла не совпадает с заголовком: " + filename);
+    }
+}
+
+class ArrBin : public FormattedArray<ArrBin> {
+public:
+    ArrBin(size_t arraySize, std::pmr::memory_resource* resource = nullptr)
+        : FormattedArray(arraySize, resource) {}
+
+    ArrBin(size_t arraySize, Uninitialized tag,
+           std::pmr::memory_resource* resource = nullptr)
+        : FormattedArray(arraySize, tag, resource) {}
+
+    ArrBin(const DynamicArray& other) : FormattedArray(other) {}
+
+    ArrBin(DynamicArray&& other) noexcept : FormattedArray(std::move(other)) {}
+
+    void saveToFile() const override {
+        saveToFile(makeOutputFilename(".bin"));
+    }
+
+    void saveToFile(const std::string& filename) const {
+        // Разреженный массив разворачивается во временный буфер, сам
+        // массив остается разреженным
+        const int* values = data;
+        std::vector<int> expanded;
+        if (sparse) {
+            expanded.resize(size);
+            copyValues(0, size, expanded.data());
+            values = expanded.data();
+        }
+        commitFile(filename, std::ios::out | std::ios::binary, [&](std::ofstream& file) {
+            BinaryHeader header = {};
+            std::memcpy(header.magic, binaryMagic, sizeof(header.magic));
+            header.version = binaryVersion;
+            header.elementWidth = sizeof(int32_t);
+            header.count = size;
+            header.checksum = binaryChecksum(values, size);
+
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            if (size > 0) {
+                file.write(reinterpret_cast<const char*>(values), static_cast<std::streamsize>(size * sizeof(int)));
             }
+        });
+        std::cout << "Массив сохранен в файл: " << filename << std::endl;
+    }
+
+    // Читает файл целиком в память и проверяет контрольную сумму
+    static ArrBin loadFromFile(const std::string& filename) {
+        std::ifstream file(filename, std::ios::binary | std::ios::ate);
+
+        if (!file.is_open()) {
+            throw std::runtime_error("Не удалось открыть файл для чтения: " + filename);
         }
-        std::cout << std::endl;
+
+        uint64_t fileSize = static_cast<uint64_t>(file.tellg());
+        file.seekg(0);
+
+        BinaryHeader header = {};
+        file.read(reinterpret_cast<char*>(&header), sizeof(header));
+        validateBinaryHeader(header, fileSize, filename);
+
+        ArrBin result(0);
+        result.reserve(static_cast<size_t>(header.count));
+        if (header.count > 0) {
+            file.read(reinterpret_cast<char*>(result.data), static_cast<std::streamsize>(header.count * sizeof(int)));
+        }
+        if (!file) {
+            throw std::runtime_error("Ошибка чтения файла: " + filename);
+        }
+        result.size = static_cast<size_t>(header.count);
+
+        if (binaryChecksum(result.data, result.size) != header.checksum) {
+            throw std::runtime_error("Контрольная сумма не совпадает: " + filename);
+        }
+        // Контрольная сумма защищает только от порчи, но не от файла,
+        // записанного с чужими значениями
+        size_t bad = selectRangeCheckKernel()(result.data, result.size);
+        if (bad < result.size) {
+            throw std::invalid_argument("Значение элемента " + std::to_string(bad) +
+                                        " вне диапазона от -100 до 100 в файле: " + filename);
+        }
+        result.chooseStorage();
+        return result;
     }
+};
 
-    void setValue(size_t index, int value) {
-        if (index >= size) {
-            throw std::out_of_range("Индекс выходит за границы массива");
+// Отображение файла ArrBin в память только для чтения: открытие не читает
+// данные, страницы подгружаются при первом обращении. Контрольная сумма и
+// диапазон значений проверяются только по запросу, так как требуют
+// прочитать весь файл. getValue проверяет диапазон одного значения,
+// getData отдает непроверенные данные файла.
+class ArrBinView {
+public:
+    explicit ArrBinView(const std::string& filename) : mapping(nullptr), mappedBytes(0), values(nullptr), count(0), expectedChecksum(0) {
+#ifdef _WIN32
+        HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                  OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            throw std::runtime_error("Не удалось открыть файл для чтения: " + filename);
         }
-        if (value < -100 || value > 100) {
-            throw std::invalid_argument("Значение должно быть в диапазоне от -100 до 100");
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize)) {
+            CloseHandle(file);
+            throw std::runtime_error("Не удалось определить размер файла: " + filename);
         }
-        data[index] = value;
+        mappedBytes = static_cast<uint64_t>(fileSize.QuadPart);
+        HANDLE section = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(file);
+        if (section == nullptr) {
+            throw std::runtime_error("Не удалось отобразить файл в память: " + filename);
+        }
+        mapping = MapViewOfFile(section, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(section);
+        if (mapping == nullptr) {
+            throw std::runtime_error("Не удалось отобразить файл в память: " + filename);
+        }
+#else
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Не удалось открыть файл для чтения: " + filename);
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0) {
+            close(fd);
+            throw std::runtime_error("Не удалось определить размер файла: " + filename);
+        }
+        mappedBytes = static_cast<uint64_t>(info.st_size);
+        void* address = (mappedBytes > 0) ? mmap(nullptr, static_cast<size_t>(mappedBytes), PROT_READ, MAP_SHARED, fd, 0)
+                                          : MAP_FAILED;
+        close(fd);
+        if (address == MAP_FAILED) {
+            throw std::runtime_error("Не удалось отобразить файл в память: " + filename);
+        }
+        mapping = address;
+#endif
+        try {
+            BinaryHeader header;
+            std::memcpy(&header, mapping, (mappedBytes < sizeof(header)) ? static_cast<size_t>(mappedBytes) : sizeof(header));
+            validateBinaryHeader(header, mappedBytes, filename);
+            count = static_cast<size_t>(header.count);
+            expectedChecksum = header.checksum;
+            values = reinterpret_cast<const int*>(static_cast<const char*>(mapping) + sizeof(BinaryHeader));
+        } catch (...) {
+            unmap();
+            throw;
+        }
+    }
+
+    ~ArrBinView() {
+        unmap();
+    }
+
+    ArrBinView(const ArrBinView&) = delete;
+    ArrBinView& operator=(const ArrBinView&) = delete;
+
+    size_t getSize() const {
+        return count;
     }
 
     int getValue(size_t index) const {
-        if (index >= size) {
+        if (index >= count) {
             throw std::out_of_range("Индекс выходит за границы массива");
         }
-        return data[index];
-    }
-
-    void pushBack(int value) {
+        int value = values[index];
         if (value < -100 || value > 100) {
-            throw std::invalid_argument("Значение должно быть в диапазоне от -100 до 100");
+            throw std::invalid_argument("Значение элемента " + std::to_string(index) +
+                                        " вне диапазона от -100 до 100 в отображенном файле");
         }
+        return value;
+    }
 
-        size_t newSize = size + 1;
-        int* newData = new int[newSize];
+    // Данные не проверены: перед использованием вызовите verifyRange
+    const int* getData() const {
+        return values;
+    }
 
-        for (size_t i = 0; i < size; ++i) {
-            newData[i] = data[i];
-        }
+    bool verifyChecksum() const {
+        return binaryChecksum(values, count) == expectedChecksum;
+    }
 
-        newData[size] = value;
-        delete[] data;
-        data = newData;
-        size = newSize;
+    bool verifyRange() const {
+        return selectRangeCheckKernel()(values, count) == count;
     }
 
-    virtual DynamicArray* add(const DynamicArray& other) const = 0;
+private:
+    void unmap() {
+        if (mapping == nullptr) {
+            return;
+        }
+#ifdef _WIN32
+        UnmapViewOfFile(mapping);
+#else
+        munmap(mapping, static_cast<size_t>(mappedBytes));
+#endif
+        mapping = nullptr;
+    }
 
-    virtual DynamicArray* subtract(const DynamicArray& other) const = 0;
+    void* mapping;
+    uint64_t mappedBytes;
+    const int* values;
+    size_t count;
+    uint64_t expectedChecksum;
+};
 
-    size_t getSize() const {
-        return size;
+// Сжатый формат ArrPack. Массив режется на блоки по packedBlockSize
+// элементов, каждый блок кодируется независимо, поэтому блоки можно
+// распаковывать параллельно и читать произвольный диапазон.
+//
+// Файл: PackedHeader, таблица из blockCount + 1 смещений (uint64, от начала
+// области блоков), затем блоки. Блок: ширина в битах (uint8), база (int8) и
+// поток серий. Серия начинается с varint (длина << 1 | вид): вид 0 - серия
+// нулей, вид 1 - длина значений (value - база) по width бит, упакованных
+// подряд и выровненных на байт в конце серии.
+struct PackedHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t blockSize;
+    uint32_t reserved;
+    uint64_t count;
+    uint64_t blockCount;
+};
+
+static_assert(sizeof(PackedHeader) == 32, "Заголовок ArrPack должен занимать 32 байта");
+
+const char packedMagic[4] = {'D', 'A', 'R', 'P'};
+const uint32_t packedVersion = 1;
+const uint32_t packedBlockSize = 65536;
+const size_t minZeroRun = 8;
+
+inline void appendVarint(std::vector<unsigned char>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<unsigned char>(value | 0x80));
+        value >>= 7;
     }
+    out.push_back(static_cast<unsigned char>(value));
+}
 
-    DynamicArray& operator=(const DynamicArray& other) {
-        if (this != &other) {
-            delete[] data;
-            size = other.size;
-            if (size > 0) {
-                data = new int[size];
-                for (size_t i = 0; i < size; ++i) {
-                    data[i] = other.data[i];
-                }
-            } else {
-                data = nullptr;
-            }
+inline bool readVarint(const unsigned char*& p, const unsigned char* end, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && p < end; shift += 7) {
+        unsigned char byte = *p++;
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
         }
-        return *this;
     }
+    return false;
+}
 
-    virtual void saveToFile() const = 0;
+// Длина серии нулей, начинающейся с позиции i
+inline size_t zeroRunLength(const int* values, size_t i, size_t count) {
+    size_t j = i;
+    while (j < count && values[j] == 0) {
+        ++j;
+    }
+    return j - i;
+}
 
-protected:
-    std::string getCurrentDateTime() const {
-        auto now = std::chrono::system_clock::now();
-        auto time_t = std::chrono::system_clock::to_time_t(now);
-        
-        std::stringstream ss;
-        ss << std::put_time(std::localtime(&time_t), "%Y-%m-%d_%H-%M-%S");
-        return ss.str();
+inline void encodePackedBlock(const int* values, size_t count, std::vector<unsigned char>& out) {
+    // Диапазон значений вне длинных серий нулей определяет базу и ширину
+    int low = 100;
+    int high = -100;
+    for (size_t i = 0; i < count;) {
+        size_t zeros = zeroRunLength(values, i, count);
+        if (zeros >= minZeroRun) {
+            i += zeros;
+            continue;
+        }
+        size_t end = i + (zeros > 0 ? zeros : 1);
+        for (; i < end; ++i) {
+            low = (values[i] < low) ? values[i] : low;
+            high = (values[i] > high) ? values[i] : high;
+        }
+    }
+    if (low > high) {
+        low = high = 0;
+    }
+    unsigned width = 0;
+    while ((1 << width) <= high - low) {
+        ++width;
     }
-};
 
-class ArrTxt : public DynamicArray {
-public:
-    ArrTxt(size_t arraySize) : DynamicArray(arraySize) {}
-    
-    ArrTxt(const DynamicArray& other) : DynamicArray(other) {}
+    out.push_back(static_cast<unsigned char>(width));
+    out.push_back(static_cast<unsigned char>(static_cast<int8_t>(low)));
 
-    DynamicArray* add(const DynamicArray& other) const override {
-        size_t maxSize = (size > other.getSize()) ? size : other.getSize();
-        ArrTxt* result = new ArrTxt(maxSize);
+    size_t i = 0;
+    while (i < count) {
+        size_t zeros = zeroRunLength(values, i, count);
+        if (zeros >= minZeroRun) {
+            appendVarint(out, static_cast<uint64_t>(zeros) << 1);
+            i += zeros;
+            continue;
+        }
 
-        for (size_t i = 0; i < maxSize; ++i) {
-            int value1 = (i < size) ? data[i] : 0;
-            int value2 = (i < other.getSize()) ? other.getValue(i) : 0;
-            int sum = value1 + value2;
-            
-            if (sum < -100) sum = -100;
-            if (sum > 100) sum = 100;
-            
-            result->data[i] = sum;
+        // Литеральная серия идет до следующей длинной серии нулей
+        size_t end = i;
+        while (end < count) {
+            size_t run = zeroRunLength(values, end, count);
+            if (run >= minZeroRun) {
+                break;
+            }
+            end += (run > 0) ? run : 1;
         }
+        appendVarint(out, (static_cast<uint64_t>(end - i) << 1) | 1);
 
-        return result;
+        uint64_t bits = 0;
+        unsigned filled = 0;
+        for (; i < end; ++i) {
+            bits |= static_cast<uint64_t>(values[i] - low) << filled;
+            filled += width;
+            while (filled >= 8) {
+                out.push_back(static_cast<unsigned char>(bits));
+                bits >>= 8;
+                filled -= 8;
+            }
+        }
+        if (filled > 0) {
+            out.push_back(static_cast<unsigned char>(bits));
+        }
     }
+}
 
-    DynamicArray* subtract(const DynamicArray& other) const override {
-        size_t maxSize = (size > other.getSize()) ? size : other.getSize();
-        ArrTxt* result = new ArrTxt(maxSize);
+// Возвращает false, если блок поврежден
+inline bool decodePackedBlock(const unsigned char* p, const unsigned char* end, int* out, size_t count) {
+    if (end - p < 2) {
+        return false;
+    }
+    unsigned width = p[0];
+    int base = static_cast<int8_t>(p[1]);
+    p += 2;
+    if (width > 8 || base < -100) {
+        return false;
+    }
+    const uint64_t mask = (uint64_t(1) << width) - 1;
 
-        for (size_t i = 0; i < maxSize; ++i) {
-            int value1 = (i < size) ? data[i] : 0;
-            int value2 = (i < other.getSize()) ? other.getValue(i) : 0;
-            int diff = value1 - value2;
-            
-            if (diff < -100) diff = -100;
-            if (diff > 100) diff = 100;
-            
-            result->data[i] = diff;
+    unsigned highest = 0;
+    size_t produced = 0;
+    while (produced < count) {
+        uint64_t token = 0;
+        if (!readVarint(p, end, token)) {
+            return false;
+        }
+        uint64_t length = token >> 1;
+        if (length == 0 || length > count - produced) {
+            return false;
         }
 
-        return result;
-    }
+        if ((token & 1) == 0) {
+            std::memset(out + produced, 0, static_cast<size_t>(length) * sizeof(int));
+            produced += static_cast<size_t>(length);
+            continue;
+        }
 
-    void saveToFile() const override {
-        std::string filename = getCurrentDateTime() + ".txt";
-        std::ofstream file(filename);
-        
-        if (!file.is_open()) {
-            throw std::runtime_error("Не удалось открыть файл для записи: " + filename);
+        uint64_t bytes = (length * width + 7) / 8;
+        if (bytes > static_cast<uint64_t>(end - p)) {
+            return false;
         }
-        
-        file << "Массив [размер: " << size << "]:\n";
-        for (size_t i = 0; i < size; ++i) {
-            file << "Элемент " << i << ": " << data[i];
-            if (i < size - 1) {
-                file << "\n";
+        uint64_t bits = 0;
+        unsigned filled = 0;
+        for (uint64_t k = 0; k < length; ++k) {
+            while (filled < width) {
+                bits |= static_cast<uint64_t>(*p++) << filled;
+                filled += 8;
             }
+            unsigned raw = static_cast<unsigned>(bits & mask);
+            highest = (raw > highest) ? raw : highest;
+            out[produced++] = base + static_cast<int>(raw);
+            bits >>= width;
+            filled -= width;
         }
-        
-        file.close();
-        std::cout << "Массив сохранен в файл: " << filename << std::endl;
     }
-};
+    return p == end && base + static_cast<int>(highest) <= 100;
+}
 
-class ArrCSV : public DynamicArray {
+class ArrPack : public FormattedArray<ArrPack> {
 public:
-    ArrCSV(size_t arraySize) : DynamicArray(arraySize) {}
-    
-    ArrCSV(const DynamicArray& other) : DynamicArray(other) {}
+    ArrPack(size_t arraySize, std::pmr::memory_resource* resource = nullptr)
+        : FormattedArray(arraySize, resource) {}
 
-    DynamicArray* add(const DynamicArray& other) const override {
-        size_t maxSize = (size > other.getSize()) ? size : other.getSize();
-        ArrCSV* result = new ArrCSV(maxSize);
+    ArrPack(size_t arraySize, Uninitialized tag,
+            std::pmr::memory_resource* resource = nullptr)
+        : FormattedArray(arraySize, tag, resource) {}
 
-        for (size_t i = 0; i < maxSize; ++i) {
-            int value1 = (i < size) ? data[i] : 0;
-            int value2 = (i < other.getSize()) ? other.getValue(i) : 0;
-            int sum = value1 + value2;
-            
-            if (sum < -100) sum = -100;
-            if (sum > 100) sum = 100;
-            
-            result->data[i] = sum;
+    ArrPack(const DynamicArray& other) : FormattedArray(other) {}
+
+    ArrPack(DynamicArray&& other) noexcept : FormattedArray(std::move(other)) {}
+
+    void saveToFile() const override {
+        saveToFile(makeOutputFilename(".pack"));
+    }
+
+    void saveToFile(const std::string& filename) const {
+        uint64_t blockCount = (size + packedBlockSize - 1) / packedBlockSize;
+        std::vector<uint64_t> offsets(static_cast<size_t>(blockCount) + 1, 0);
+        std::vector<unsigned char> blocks;
+        std::vector<int> expanded(sparse ? packedBlockSize : 0);
+        for (uint64_t block = 0; block < blockCount; ++block) {
+            size_t first = static_cast<size_t>(block) * packedBlockSize;
+            size_t count = (size - first < packedBlockSize) ? size - first : packedBlockSize;
+            const int* values = sparse ? expanded.data() : data + first;
+            if (sparse) {
+                copyValues(first, count, expanded.data());
+            } else {
+                // База и ширина блока рассчитаны на значения из [-100, 100]
+                size_t bad = selectRangeCheckKernel()(values, count);
+                if (bad < count) {
+                    throw std::invalid_argument("Значение с индексом " + std::to_string(first + bad) +
+                                                " должно быть в диапазоне от -100 до 100");
+                }
+            }
+            encodePackedBlock(values, count, blocks);
+            offsets[static_cast<size_t>(block) + 1] = blocks.size();
         }
 
-        return result;
+        commitFile(filename, std::ios::out | std::ios::binary, [&](std::ofstream& file) {
+            PackedHeader header = {};
+            std::memcpy(header.magic, packedMagic, sizeof(header.magic));
+            header.version = packedVersion;
+            header.blockSize = packedBlockSize;
+            header.count = size;
+            header.blockCount = blockCount;
+
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file.write(reinterpret_cast<const char*>(offsets.data()),
+                       static_cast<std::streamsize>(offsets.size() * sizeof(uint64_t)));
+            if (!blocks.empty()) {
+                file.write(reinterpret_cast<const char*>(blocks.data()), static_cast<std::streamsize>(blocks.size()));
+            }
+        });
+        std::cout << "Массив сохранен в файл: " << filename << std::endl;
     }
 
-    DynamicArray* subtract(const DynamicArray& other) const override {
-        size_t maxSize = (size > other.getSize()) ? size : other.getSize();
-        ArrCSV* result = new ArrCSV(maxSize);
+    // Читает весь файл и распаковывает блоки в нескольких потоках
+    static ArrPack loadFromFile(const std::string& filename) {
+        PackedFile file(filename);
+        return file.decode(0, file.getCount());
+    }
 
-        for (size_t i = 0; i < maxSize; ++i) {
-            int value1 = (i < size) ? data[i] : 0;
-            int value2 = (i < other.getSize()) ? other.getValue(i) : 0;
-            int diff = value1 - value2;
-            
-            if (diff < -100) diff = -100;
-            if (diff > 100) diff = 100;
-            
-            result->data[i] = diff;
+    // Распаковывает только блоки, покрывающие [first, first + count)
+    static ArrPack loadRange(const std::string& filename, size_t first, size_t count) {
+        PackedFile file(filename);
+        if (first > file.getCount() || count > file.getCount() - first) {
+            throw std::out_of_range("Диапазон выходит за границы массива в файле: " + filename);
         }
-
-        return result;
+        return file.decode(first, count);
     }
 
-    void saveToFile() const override {
-        std::string filename = getCurrentDateTime() + ".csv";
-        std::ofstream file(filename);
-        
-        if (!file.is_open()) {
-            throw std::runtime_error("Не удалось открыть файл для записи: " + filename);
+private:
+    // Заголовок и таблица смещений; сами блоки читаются по требованию
+    class PackedFile {
+    public:
+        explicit PackedFile(const std::string& name) : filename(name), stream(name, std::ios::binary) {
+            if (!stream.is_open()) {
+                throw std::runtime_error("Не удалось открыть файл для чтения: " + filename);
+            }
+            stream.seekg(0, std::ios::end);
+            uint64_t fileSize = static_cast<uint64_t>(stream.tellg());
+            stream.seekg(0);
+
+            stream.read(reinterpret_cast<char*>(&header), sizeof(header));
+            if (!stream || std::memcmp(header.magic, packedMagic, sizeof(header.magic)) != 0) {
+                throw std::runtime_error("Файл не является массивом ArrPack: " + filename);
+            }
+            if (header.version != packedVersion || header.blockSize == 0 ||
+                header.blockCount != (header.count + header.blockSize - 1) / header.blockSize ||
+                header.blockCount >= (fileSize - sizeof(header)) / sizeof(uint64_t)) {
+                throw std::runtime_error("Неверный заголовок ArrPack в файле: " + filename);
+            }
+
+            offsets.resize(static_cast<size_t>(header.blockCount) + 1);
+            stream.read(reinterpret_cast<char*>(offsets.data()),
+                        static_cast<std::streamsize>(offsets.size() * sizeof(uint64_t)));
+            dataStart = sizeof(header) + offsets.size() * sizeof(uint64_t);
+            if (!stream || offsets[0] != 0 || dataStart + offsets.back() != fileSize) {
+                throw std::runtime_error("Неверная таблица блоков в файле: " + filename);
+            }
+            for (size_t i = 1; i < offsets.size(); ++i) {
+                if (offsets[i] < offsets[i - 1]) {
+                    throw std::runtime_error("Неверная таблица блоков в файле: " + filename);
+                }
+            }
         }
-        
-        file << "Index,Value\n";
-        for (size_t i = 0; i < size; ++i) {
-            file << i << "," << data[i];
-            if (i < size - 1) {
-                file << "\n";
+
+        size_t getCount() const {
+            return static_cast<size_t>(header.count);
+        }
+
+        ArrPack decode(size_t first, size_t count) {
+            ArrPack result(0);
+            if (count == 0) {
+                return result;
+            }
+            size_t blockSize = header.blockSize;
+            size_t firstBlock = first / blockSize;
+            size_t lastBlock = (first + count - 1) / blockSize;
+
+            std::vector<unsigned char> bytes(static_cast<size_t>(offsets[lastBlock + 1] - offsets[firstBlock]));
+            stream.seekg(static_cast<std::streamoff>(dataStart + offsets[firstBlock]));
+            stream.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+            if (!stream) {
+                throw std::runtime_error("Ошибка чтения файла: " + filename);
+            }
+
+            // Блоки распаковываются целиком прямо в буфер результата,
+            // затем нужный диапазон сдвигается к началу
+            size_t blockElements = (lastBlock - firstBlock + 1) * blockSize;
+            size_t available = getCount() - firstBlock * blockSize;
+            size_t decoded = (blockElements < available) ? blockElements : available;
+            result.reserve(decoded);
+            int* values = result.data;
+
+            size_t blocks = lastBlock - firstBlock + 1;
+            size_t threadCount = std::thread::hardware_concurrency();
+            threadCount = (threadCount == 0) ? 1 : threadCount;
+            threadCount = (threadCount > blocks) ? blocks : threadCount;
+
+            std::atomic<bool> corrupted(false);
+            auto decodeBlocks = [&](size_t from, size_t to) {
+                for (size_t block = from; block < to; ++block) {
+                    size_t index = firstBlock + block;
+                    const unsigned char* begin = bytes.data() + (offsets[index] - offsets[firstBlock]);
+                    const unsigned char* end = bytes.data() + (offsets[index + 1] - offsets[firstBlock]);
+                    size_t offset = block * blockSize;
+                    size_t elements = (decoded - offset < blockSize) ? decoded - offset : blockSize;
+                    if (!decodePackedBlock(begin, end, values + offset, elements)) {
+                        corrupted = true;
+                    }
+                }
+            };
+
+            std::vector<std::thread> workers;
+            for (size_t t = 1; t < threadCount; ++t) {
+                workers.emplace_back(decodeBlocks, blocks * t / threadCount, blocks * (t + 1) / threadCount);
+            }
+            decodeBlocks(0, blocks / threadCount);
+            for (size_t t = 0; t < workers.size(); ++t) {
+                workers[t].join();
+            }
+            if (corrupted) {
+                throw std::runtime_error("Поврежденный блок в файле: " + filename);
             }
+
+            size_t skip = first - firstBlock * blockSize;
+            if (skip > 0) {
+                std::memmove(values, values + skip, count * sizeof(int));
+            }
+            result.size = count;
+            result.chooseStorage();
+            return result;
         }
-        
-        file.close();
-        std::cout << "Массив сохранен в файл: " << filename << std::endl;
-    }
+
+    private:
+        std::string filename;
+        std::ifstream stream;
+        PackedHeader header;
+        std::vector<uint64_t> offsets;
+        uint64_t dataStart;
+    };
 };
 
 void saveArray(const DynamicArray& array) {
@@ -256,47 +2457,66 @@ int main() {
         
         std::cout << "Введите размер первого массива: ";
         std::cin >> size1;
-        ArrTxt arr1(size1);
+        ArrTxt arr1(0);
         
         std::cout << "Введите " << size1 << " элементов первого массива (от -100 до 100):" << std::endl;
+        // Значение проверяется сразу после ввода, весь ввод копируется в массив
+        // одним assign, без предварительного заполнения нулями
+        std::vector<int> values1;
+        values1.reserve(size1);
         for (int i = 0; i < size1; ++i) {
             int value;
             std::cin >> value;
-            arr1.setValue(i, value);
+            if (value < -100 || value > 100) {
+                throw std::invalid_argument("Значение должно быть в диапазоне от -100 до 100");
+            }
+            values1.push_back(value);
         }
+        arr1.assign(values1.data(), values1.data() + values1.size());
         
         std::cout << "Введите размер второго массива: ";
         std::cin >> size2;
-        ArrCSV arr2(size2);
+        ArrCSV arr2(0);
         
         std::cout << "Введите " << size2 << " элементов второго массива (от -100 до 100):" << std::endl;
+        std::vector<int> values2;
+        values2.reserve(size2);
         for (int i = 0; i < size2; ++i) {
             int value;
             std::cin >> value;
-            arr2.setValue(i, value);
+            if (value < -100 || value > 100) {
+                throw std::invalid_argument("Значение должно быть в диапазоне от -100 до 100");
+            }
+            values2.push_back(value);
         }
+        arr2.assign(values2.data(), values2.data() + values2.size());
         
         std::cout << "\nПервый массив: ";
         arr1.print();
         std::cout << "Второй массив: ";
         arr2.print();
         
-        // Используем указатели для результатов операций
-        DynamicArray* sum = arr1.add(arr2);
+        // Результат имеет формат левого операнда
+        ArrTxt sum = arr1.add(arr2);
         std::cout << "Результат сложения: ";
-        sum->print();
+        sum.print();
         
-        DynamicArray* diff = arr1.subtract(arr2);
+        ArrTxt diff = arr1.subtract(arr2);
         std::cout << "Результат вычитания: ";
-        diff->print();
+        diff.print();
         
         // Демонстрация полиморфизма
         std::cout << "\nСохранение массивов в файлы..." << std::endl;
         
-        DynamicArray* arrays[] = {&arr1, &arr2, sum, diff};
+        DynamicArray* arrays[] = {&arr1, &arr2, &sum, &diff};
         
+        // Запись идет в фоновом потоке, здесь можно продолжать работу
+        std::vector<std::future<void>> pendingSaves;
         for (int i = 0; i < 4; i++) {
-            arrays[i]->saveToFile();
+            pendingSaves.push_back(arrays[i]->saveToFileAsync());
+        }
+        for (size_t i = 0; i < pendingSaves.size(); i++) {
+            pendingSaves[i].get();
         }
         
         // Альтернативный способ через функцию
@@ -304,6 +2524,15 @@ int main() {
         saveArray(arr1);
         saveArray(arr2);
         
+        // Двоичный формат: сохранение и открытие через отображение в память
+        std::cout << "\nСохранение в двоичном формате:" << std::endl;
+        ArrBin binary(arr1);
+        binary.saveToFile("array.bin");
+        ArrBinView view("array.bin");
+        std::cout << "Из array.bin прочитано элементов: " << view.getSize()
+                  << (view.verifyChecksum() ? " (контрольная сумма совпадает)" : " (контрольная сумма не совпадает)")
+                  << std::endl;
+        
         char choice;
         std::cout << "\nХотите добавить элементы в конец первого массива? (y/n): ";
         std::cin >> choice;
@@ -318,10 +2547,7 @@ int main() {
             
             arr1.saveToFile();
         }
-        
-        // Освобождаем память
-        delete sum;
-        delete diff;
+
         
     } catch (const std::exception& e) {
         std::cerr << "Ошибка: " << e.what() << std::endl;